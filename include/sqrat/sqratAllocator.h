@@ -31,6 +31,7 @@
 
 #include <squirrel.h>
 #include <sqstdaux.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "sqratObject.h"
@@ -41,9 +42,9 @@ namespace Sqrat {
 namespace vargs
 {
   template<typename T>
-  T&  extract(Var<T>& var)
+  decltype(auto) extract(Var<T>& var)
   {
-    return  var.value;
+    return  (var.value);
   }
 
   template<typename T>
@@ -65,8 +66,70 @@ namespace vargs
     constexpr auto argsN = SQRAT_STD::tuple_size<SQRAT_STD::decay_t<Tuple>>::value;
     return apply_ctor_helper<C>(SQRAT_STD::make_index_sequence<argsN>(), tup);
   }
+
+  template <class C, class Tuple, size_t... Indexes>
+  C *apply_ctor_at_helper(void *mem, SQRAT_STD::index_sequence<Indexes...>, Tuple &&args)
+  {
+    (void)args; // 'args' is unused in case of empty 'Indexes'
+    return new (mem) C(extract(SQRAT_STD::get<Indexes>(args))...);
+  }
+
+  template <class C, class Tuple>
+  C *apply_ctor_at(void *mem, Tuple &&tup)
+  {
+    constexpr auto argsN = SQRAT_STD::tuple_size<SQRAT_STD::decay_t<Tuple>>::value;
+    return apply_ctor_at_helper<C>(mem, SQRAT_STD::make_index_sequence<argsN>(), tup);
+  }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Calls the optional A::InitClass(vm, cd) hook of an allocator once the class object has been created
+///
+/// \remarks
+/// Allocators can use it to set up the class object (e.g. its userdata size) before any instance is created.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class C, class A, class = void>
+struct AllocatorInitClass
+{
+    static void Init(HSQUIRRELVM, ClassData<C>*) {}
+};
+
+template <class C, class A>
+struct AllocatorInitClass<C, A, void_t<decltype(&A::InitClass)>>
+{
+    static void Init(HSQUIRRELVM vm, ClassData<C>* cd) { A::InitClass(vm, cd); }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Returns the function setting up the instance at idx by moving from a value of the same type, or NULL if the
+/// allocator only copies
+///
+/// \remarks
+/// Allocators support moving by defining Emplace(vm, idx, value), which sets up the instance at idx with an object
+/// constructed from value (forwarded as is). Classes that can't be move constructed are copied with A::Copy instead.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class C, class A, class = void>
+struct AllocatorMoveFunc
+{
+    static MOVEFUNC Get() { return NULL; }
+};
+
+template <class C, class A>
+struct AllocatorMoveFunc<C, A, void_t<decltype(A::Emplace(SQRAT_STD::declval<HSQUIRRELVM>(), SQInteger(),
+                                                           SQRAT_STD::declval<C>()))>>
+{
+    static MOVEFUNC Get() { return &Move; }
+
+private:
+
+    static SQInteger Move(HSQUIRRELVM vm, SQInteger idx, void* value) {
+        if constexpr (SQRAT_STD::is_move_constructible<C>::value)
+            return A::Emplace(vm, idx, SQRAT_STD::move(*static_cast<C*>(value)));
+        else
+            return A::Copy(vm, idx, value);
+    }
+};
+
 template <class T, bool b>
 struct NewC
 {
@@ -87,6 +150,22 @@ struct NewC<T, false>
     }
 };
 
+// Number of instances carved out of each slab allocated by PoolAllocator
+#ifndef SQRAT_POOL_SLAB_SIZE
+#define SQRAT_POOL_SLAB_SIZE 64
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Occupancy of the pool of a class bound with PoolAllocator in a VM
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct PoolAllocatorStats {
+    size_t blockSize; ///< Bytes taken by each instance, including its bookkeeping
+    size_t slabs;     ///< Number of slabs allocated
+    size_t capacity;  ///< Number of instances the slabs can hold
+    size_t used;      ///< Number of instances currently alive
+    size_t peak;      ///< Highest number of instances alive at once
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// DefaultAllocator is the allocator to use for Class that can both be constructed and copied
 ///
@@ -112,9 +191,10 @@ public:
     static void SetInstance(HSQUIRRELVM vm, SQInteger idx, C* ptr)
     {
         ClassData<C>* cd = ClassType<C>::getClassData(vm);
-        sq_setinstanceup(vm, idx, new InstancePtrAndMap<C>(ptr, cd->instances));
+        sq_setinstanceup(vm, idx, new OwnedInstance<C>(ptr, cd));
         sq_setreleasehook(vm, idx, &Delete);
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
+        if (cd->instances && ptr)
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
     }
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -139,9 +219,10 @@ public:
 
     template <typename...A>
     static SQInteger iNew(HSQUIRRELVM vm) {
-        if (!vargs::check_var_types<A...>(vm, 2))
+        vargs::VarObjects<sizeof...(A)> objs;
+        if (!vargs::get_var_objects<A...>(vm, 2, objs))
             return SQ_ERROR;
-        auto vars = vargs::make_vars<A...>(vm, 2);
+        auto vars = vargs::make_vars<A...>(vm, 2, objs);
         C *inst = vargs::apply_ctor<C>(vars);
         SetInstance(vm, 1, inst);
         return 0;
@@ -155,12 +236,13 @@ public:
 
     template <typename...A>
     static SQInteger iNewVM(HSQUIRRELVM vm) {
-        if (!vargs::check_var_types<A...>(vm, 2))
+        vargs::VarObjects<sizeof...(A)> objs;
+        if (!vargs::get_var_objects<A...>(vm, 2, objs))
             return SQ_ERROR;
 
         auto args = SQRAT_STD::tuple_cat(
           SQRAT_STD::make_tuple<HSQUIRRELVM&>(vm),
-          vargs::make_vars<A...>(vm, 2)
+          vargs::make_vars<A...>(vm, 2, objs)
         );
 
         C *inst = vargs::apply_ctor<C>(args);
@@ -181,7 +263,13 @@ public:
     ///
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     static SQInteger Copy(HSQUIRRELVM vm, SQInteger idx, const void* value) {
-        SetInstance(vm, idx, new C(*static_cast<const C*>(value)));
+        return Emplace(vm, idx, *static_cast<const C*>(value));
+    }
+
+    /// Sets up the instance at idx on the stack with an object constructed from value (see AllocatorMoveFunc)
+    template <class V>
+    static SQInteger Emplace(HSQUIRRELVM vm, SQInteger idx, V&& value) {
+        SetInstance(vm, idx, new C(SQRAT_STD::forward<V>(value)));
         return 0;
     }
 
@@ -196,9 +284,10 @@ public:
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     static SQInteger Delete(SQUserPointer ptr, SQInteger size) {
         SQRAT_UNUSED(size);
-        InstancePtrAndMap<C>* instance = reinterpret_cast<InstancePtrAndMap<C>*>(ptr);
-        instance->second->erase(instance->first);
-        delete instance->first;
+        OwnedInstance<C>* instance = reinterpret_cast<OwnedInstance<C>*>(ptr);
+        if (instance->second)
+            instance->second->erase(instance->first);
+        instance->DeleteObject();
         delete instance;
         return 0;
     }
@@ -225,9 +314,10 @@ public:
     static void SetInstance(HSQUIRRELVM vm, SQInteger idx, C* ptr)
     {
         ClassData<C>* cd = ClassType<C>::getClassData(vm);
-        sq_setinstanceup(vm, idx, new InstancePtrAndMap<C>(ptr, cd->instance));
+        sq_setinstanceup(vm, idx, new OwnedInstance<C>(ptr, cd));
         sq_setreleasehook(vm, idx, &Delete);
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
+        if (cd->instances && ptr)
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
     }
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -270,9 +360,10 @@ public:
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     static SQInteger Delete(SQUserPointer ptr, SQInteger size) {
         SQRAT_UNUSED(size);
-        InstancePtrAndMap<C> *instance = reinterpret_cast<InstancePtrAndMap<C> *>(ptr);
-        instance->second->erase(instance->first);
-        delete instance->first;
+        OwnedInstance<C>* instance = reinterpret_cast<OwnedInstance<C>*>(ptr);
+        if (instance->second)
+            instance->second->erase(instance->first);
+        instance->DeleteObject();
         delete instance;
         return 0;
     }
@@ -299,9 +390,10 @@ public:
     static void SetInstance(HSQUIRRELVM vm, SQInteger idx, C* ptr)
     {
         ClassData<C>* cd = ClassType<C>::getClassData(vm);
-        sq_setinstanceup(vm, idx, new InstancePtrAndMap<C>(ptr, cd->instances));
+        sq_setinstanceup(vm, idx, new OwnedInstance<C>(ptr, cd));
         sq_setreleasehook(vm, idx, &Delete);
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
+        if (cd->instances && ptr)
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
     }
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -327,7 +419,13 @@ public:
     ///
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     static SQInteger Copy(HSQUIRRELVM vm, SQInteger idx, const void* value) {
-        SetInstance(vm, idx, new C(*static_cast<const C*>(value)));
+        return Emplace(vm, idx, *static_cast<const C*>(value));
+    }
+
+    /// Sets up the instance at idx on the stack with an object constructed from value (see AllocatorMoveFunc)
+    template <class V>
+    static SQInteger Emplace(HSQUIRRELVM vm, SQInteger idx, V&& value) {
+        SetInstance(vm, idx, new C(SQRAT_STD::forward<V>(value)));
         return 0;
     }
 
@@ -342,9 +440,10 @@ public:
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     static SQInteger Delete(SQUserPointer ptr, SQInteger size) {
         SQRAT_UNUSED(size);
-        InstancePtrAndMap<C> *instance = reinterpret_cast<InstancePtrAndMap<C> *>(ptr);
-        instance->second->erase(instance->first);
-        delete instance->first;
+        OwnedInstance<C>* instance = reinterpret_cast<OwnedInstance<C>*>(ptr);
+        if (instance->second)
+            instance->second->erase(instance->first);
+        instance->DeleteObject();
         delete instance;
         return 0;
     }
@@ -375,9 +474,10 @@ public:
     static void SetInstance(HSQUIRRELVM vm, SQInteger idx, C* ptr)
     {
         ClassData<C>* cd = ClassType<C>::getClassData(vm);
-        sq_setinstanceup(vm, idx, new InstancePtrAndMap<C>(ptr, cd->instances));
+        sq_setinstanceup(vm, idx, new OwnedInstance<C>(ptr, cd));
         sq_setreleasehook(vm, idx, &Delete);
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
+        if (cd->instances && ptr)
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
     }
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -402,9 +502,10 @@ public:
 
     template <typename...A>
     static SQInteger iNew(HSQUIRRELVM vm) {
-        if (!vargs::check_var_types<A...>(vm, 2))
+        vargs::VarObjects<sizeof...(A)> objs;
+        if (!vargs::get_var_objects<A...>(vm, 2, objs))
             return SQ_ERROR;
-        auto vars = vargs::make_vars<A...>(vm, 2);
+        auto vars = vargs::make_vars<A...>(vm, 2, objs);
         C *inst = vargs::apply_ctor<C>(vars);
         SetInstance(vm, 1, inst);
         return 0;
@@ -427,6 +528,202 @@ public:
         return sqstd_throwerrorf(vm, _SC("Cloning of %s is not allowed"), ClassType<C>::ClassName().c_str());
     }
 
+    /// Sets up the instance at idx on the stack with an object constructed from value (see AllocatorMoveFunc)
+    template <class V>
+    static SQInteger Emplace(HSQUIRRELVM vm, SQInteger idx, V&& value) {
+        SetInstance(vm, idx, new C(SQRAT_STD::forward<V>(value)));
+        return 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Called by Sqrat to delete an instance's data
+    ///
+    /// \param ptr  Pointer to the data contained by the instance
+    /// \param size Size of the data contained by the instance
+    ///
+    /// \return Squirrel error code
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger Delete(SQUserPointer ptr, SQInteger size) {
+        SQRAT_UNUSED(size);
+        OwnedInstance<C>* instance = reinterpret_cast<OwnedInstance<C>*>(ptr);
+        if (instance->second)
+            instance->second->erase(instance->first);
+        instance->DeleteObject();
+        delete instance;
+        return 0;
+    }
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// UntrackedInstances wraps an allocator for classes whose instances never need to keep their identity in Squirrel
+///
+/// \tparam C Type of class
+/// \tparam A The wrapped allocator (DefaultAllocator by default)
+///
+/// \remarks
+/// Sqrat normally keeps a map from native pointers to their Squirrel instances so that pushing the same pointer twice
+/// yields the same instance. Classes bound with this allocator skip that map: every push of a pointer creates a new
+/// instance, and creating or releasing an instance doesn't touch the map. Suitable for value-like classes.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class C, class A = DefaultAllocator<C>>
+class UntrackedInstances : public A {
+public:
+
+    /// Called by Sqrat when the class is created to drop the instances map
+    static void InitClass(HSQUIRRELVM vm, ClassData<C>* cd) {
+        AllocatorInitClass<C, A>::Init(vm, cd);
+        cd->instances.reset();
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// InlineAllocator is the allocator to use for Class that can both be constructed and copied, and which is small
+/// enough to be stored directly inside the Squirrel instance
+///
+/// \remarks
+/// The class userdata size is set so that the instance bookkeeping and the C object itself live in the memory of the
+/// Squirrel instance, so creating an instance takes a single allocation. C is destroyed by the release hook. C must not
+/// be over-aligned, as the userdata is aligned no stricter than max_align_t (or SQ_ALIGNMENT when it is defined).
+///
+/// \remarks
+/// Squirrel classes extending a class that uses this allocator must call base.constructor in their constructor. Their
+/// instances get the userdata before any constructor runs, so SetInstance marks the record as initialized by setting
+/// the release hook, and instances without it are rejected as unconstructed (see ClassType::GetInstanceRecord).
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class C>
+class InlineAllocator {
+
+    // Layout of the userdata of the instances
+    struct Instance {
+        OwnedInstance<C> record;
+        alignas(C) unsigned char storage[sizeof(C)];
+    };
+
+    // The userdata of an instance is only as aligned as the memory returned by the VM allocator
+    static_assert(alignof(Instance) <= alignof(max_align_t), "InlineAllocator requires a type aligned no stricter than max_align_t");
+#if defined(SQ_ALIGNMENT)
+    static_assert(alignof(Instance) <= SQ_ALIGNMENT, "InlineAllocator requires a type aligned no stricter than SQ_ALIGNMENT");
+#endif
+
+    static Instance* GetInline(HSQUIRRELVM vm, SQInteger idx) {
+        SQUserPointer up = NULL;
+        SQRAT_VERIFY(SQ_SUCCEEDED(sq_getinstanceup(vm, idx, &up, NULL)));
+        return static_cast<Instance*>(up);
+    }
+
+public:
+
+    /// Called by Sqrat when the class is created to reserve the instance userdata
+    static void InitClass(HSQUIRRELVM vm, ClassData<C>* cd) {
+        sq_pushobject(vm, cd->classObj);
+        SQRAT_VERIFY(SQ_SUCCEEDED(sq_setclassudsize(vm, -1, sizeof(Instance))));
+        sq_pop(vm, 1);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Associates a newly created instance with an object allocated with the new operator (which is automatically deleted)
+    ///
+    /// \param vm  VM that has an instance object of the correct type at idx
+    /// \param idx Index of the stack that the instance object is at
+    /// \param ptr Should be the return value from a call to the new operator, or an object constructed in GetStorage
+    ///
+    /// \remarks
+    /// This function should only need to be used when custom constructors are bound with Class::SquirrelFunc.
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static void SetInstance(HSQUIRRELVM vm, SQInteger idx, C* ptr)
+    {
+        ClassData<C>* cd = ClassType<C>::getClassData(vm);
+        new (&GetInline(vm, idx)->record) OwnedInstance<C>(ptr, cd);
+        sq_setreleasehook(vm, idx, &Delete);
+        if (cd->instances && ptr)
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
+    }
+
+    /// Returns the storage inside the instance at idx in which C can be constructed before calling SetInstance
+    static void* GetStorage(HSQUIRRELVM vm, SQInteger idx) {
+        return GetInline(vm, idx)->storage;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Called by Sqrat to set up an instance on the stack for the template class
+    ///
+    /// \param vm VM that has an instance object of the correct type at position 1 in its stack
+    ///
+    /// \return Squirrel error code
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger New(HSQUIRRELVM vm) {
+        if constexpr (SQRAT_STD::is_default_constructible<C>::value)
+            SetInstance(vm, 1, new (GetStorage(vm, 1)) C());
+        else
+            SetInstance(vm, 1, NULL);
+        return 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// following iNew functions are used only if constructors are bound via Ctor() in Sqrat::Class (safe to ignore)
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger iNew(HSQUIRRELVM vm) {
+        return New(vm);
+    }
+
+    template <typename...A>
+    static SQInteger iNew(HSQUIRRELVM vm) {
+        vargs::VarObjects<sizeof...(A)> objs;
+        if (!vargs::get_var_objects<A...>(vm, 2, objs))
+            return SQ_ERROR;
+        auto vars = vargs::make_vars<A...>(vm, 2, objs);
+        C *inst = vargs::apply_ctor_at<C>(GetStorage(vm, 1), vars);
+        SetInstance(vm, 1, inst);
+        return 0;
+    }
+
+    static SQInteger iNewVM(HSQUIRRELVM vm) {
+        C *inst = vargs::apply_ctor_at<C>(GetStorage(vm, 1), SQRAT_STD::make_tuple<HSQUIRRELVM&>(vm));
+        SetInstance(vm, 1, inst);
+        return 0;
+    }
+
+    template <typename...A>
+    static SQInteger iNewVM(HSQUIRRELVM vm) {
+        vargs::VarObjects<sizeof...(A)> objs;
+        if (!vargs::get_var_objects<A...>(vm, 2, objs))
+            return SQ_ERROR;
+
+        auto args = SQRAT_STD::tuple_cat(
+          SQRAT_STD::make_tuple<HSQUIRRELVM&>(vm),
+          vargs::make_vars<A...>(vm, 2, objs)
+        );
+
+        C *inst = vargs::apply_ctor_at<C>(GetStorage(vm, 1), args);
+        SetInstance(vm, 1, inst);
+        return 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Called by Sqrat to set up the instance at idx on the stack as a copy of a value of the same type
+    ///
+    /// \param vm    VM that has an instance object of the correct type at idx
+    /// \param idx   Index of the stack that the instance object is at
+    /// \param value A pointer to data of the same type as the instance object
+    ///
+    /// \return Squirrel error code
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger Copy(HSQUIRRELVM vm, SQInteger idx, const void* value) {
+        return Emplace(vm, idx, *static_cast<const C*>(value));
+    }
+
+    /// Sets up the instance at idx on the stack with an object constructed from value (see AllocatorMoveFunc)
+    template <class V>
+    static SQInteger Emplace(HSQUIRRELVM vm, SQInteger idx, V&& value) {
+        SetInstance(vm, idx, new (GetStorage(vm, idx)) C(SQRAT_STD::forward<V>(value)));
+        return 0;
+    }
+
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     /// Called by Sqrat to delete an instance's data
     ///
@@ -438,9 +735,429 @@ public:
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     static SQInteger Delete(SQUserPointer ptr, SQInteger size) {
         SQRAT_UNUSED(size);
-        InstancePtrAndMap<C> *instance = reinterpret_cast<InstancePtrAndMap<C> *>(ptr);
-        instance->second->erase(instance->first);
-        delete instance->first;
+        Instance* instance = reinterpret_cast<Instance*>(ptr);
+        OwnedInstance<C>& record = instance->record;
+        if (record.second)
+            record.second->erase(record.first);
+        if (record.first == reinterpret_cast<C*>(instance->storage))
+            record.first->~C();
+        else
+            record.DeleteObject();
+        record.~OwnedInstance<C>();
+        return 0;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// PoolAllocator is the allocator to use for Class that can both be constructed and copied, and which has many
+/// short-lived instances
+///
+/// \remarks
+/// Each class bound with this allocator gets a pool in each VM. The C objects and their instance bookkeeping are carved
+/// out of slabs of SQRAT_POOL_SLAB_SIZE blocks and recycled through a free list, so creating and releasing instances
+/// doesn't go to the global heap once the pool has grown. Slabs are only freed when the class data of the VM and all
+/// instances of the pool are gone. The pools are not thread safe, as VMs aren't.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class C>
+class PoolAllocator {
+
+    struct Pool;
+
+    // A pool allocation: the instance bookkeeping (or the free list link), the owning pool and the storage for C
+    struct Block {
+        union {
+            Block* nextFree;
+            alignas(OwnedInstance<C>) unsigned char record[sizeof(OwnedInstance<C>)];
+        };
+        Pool* pool;
+        alignas(C) unsigned char storage[sizeof(C)];
+
+        OwnedInstance<C>& Record() { return *reinterpret_cast<OwnedInstance<C>*>(record); }
+    };
+
+    // Owned by the class data of the VM; outlives it while it still has live blocks, as instances can be released later
+    struct Pool {
+        vector<Block*> slabs;
+        Block* freeList;
+        size_t used;
+        size_t peak;
+        bool orphaned;
+
+        Pool() : freeList(NULL), used(0), peak(0), orphaned(false) {}
+
+        ~Pool() {
+            for (Block* slab : slabs)
+                delete[] slab;
+        }
+
+        Block* Alloc() {
+            if (!freeList) {
+                Block* slab = new Block[SQRAT_POOL_SLAB_SIZE];
+                slabs.push_back(slab);
+                for (size_t i = 0; i < SQRAT_POOL_SLAB_SIZE; ++i) {
+                    slab[i].pool = this;
+                    slab[i].nextFree = (i + 1 < SQRAT_POOL_SLAB_SIZE) ? &slab[i + 1] : NULL;
+                }
+                freeList = slab;
+            }
+            Block* block = freeList;
+            freeList = block->nextFree;
+            if (++used > peak)
+                peak = used;
+            return block;
+        }
+
+        void Free(Block* block) {
+            block->nextFree = freeList;
+            freeList = block;
+            if (!--used && orphaned)
+                delete this;
+        }
+
+        static void Release(void* p) {
+            Pool* pool = static_cast<Pool*>(p);
+            if (pool->used)
+                pool->orphaned = true;
+            else
+                delete pool;
+        }
+    };
+
+    static Pool* GetPool(ClassData<C>* cd) {
+        return static_cast<Pool*>(cd->allocatorData.get());
+    }
+
+    static void Attach(HSQUIRRELVM vm, SQInteger idx, ClassData<C>* cd, Block* block, C* ptr) {
+        new (&block->Record()) OwnedInstance<C>(ptr, cd);
+        sq_setinstanceup(vm, idx, block);
+        sq_setreleasehook(vm, idx, &Delete);
+        if (cd->instances && ptr)
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
+    }
+
+    template <class Tuple>
+    static SQInteger Construct(HSQUIRRELVM vm, Tuple&& args) {
+        ClassData<C>* cd = ClassType<C>::getClassData(vm);
+        Block* block = GetPool(cd)->Alloc();
+        Attach(vm, 1, cd, block, vargs::apply_ctor_at<C>(block->storage, args));
+        return 0;
+    }
+
+public:
+
+    /// Called by Sqrat when the class is created to set up the pool of the VM
+    static void InitClass(HSQUIRRELVM, ClassData<C>* cd) {
+        cd->allocatorData.reset(new Pool, &Pool::Release);
+    }
+
+    /// Returns the occupancy of the pool of the class in the given VM
+    static PoolAllocatorStats GetStats(HSQUIRRELVM vm) {
+        Pool* pool = GetPool(ClassType<C>::getClassData(vm));
+        PoolAllocatorStats stats;
+        stats.blockSize = sizeof(Block);
+        stats.slabs = pool->slabs.size();
+        stats.capacity = pool->slabs.size() * SQRAT_POOL_SLAB_SIZE;
+        stats.used = pool->used;
+        stats.peak = pool->peak;
+        return stats;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Associates a newly created instance with an object allocated with the new operator (which is automatically deleted)
+    ///
+    /// \param vm  VM that has an instance object of the correct type at idx
+    /// \param idx Index of the stack that the instance object is at
+    /// \param ptr Should be the return value from a call to the new operator
+    ///
+    /// \remarks
+    /// This function should only need to be used when custom constructors are bound with Class::SquirrelFunc.
+    /// Only the bookkeeping of such instances comes from the pool.
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static void SetInstance(HSQUIRRELVM vm, SQInteger idx, C* ptr)
+    {
+        ClassData<C>* cd = ClassType<C>::getClassData(vm);
+        Attach(vm, idx, cd, GetPool(cd)->Alloc(), ptr);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Called by Sqrat to set up an instance on the stack for the template class
+    ///
+    /// \param vm VM that has an instance object of the correct type at position 1 in its stack
+    ///
+    /// \return Squirrel error code
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger New(HSQUIRRELVM vm) {
+        if constexpr (SQRAT_STD::is_default_constructible<C>::value)
+            return Construct(vm, SQRAT_STD::tuple<>());
+        SetInstance(vm, 1, NULL);
+        return 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// following iNew functions are used only if constructors are bound via Ctor() in Sqrat::Class (safe to ignore)
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger iNew(HSQUIRRELVM vm) {
+        return New(vm);
+    }
+
+    template <typename...A>
+    static SQInteger iNew(HSQUIRRELVM vm) {
+        vargs::VarObjects<sizeof...(A)> objs;
+        if (!vargs::get_var_objects<A...>(vm, 2, objs))
+            return SQ_ERROR;
+        return Construct(vm, vargs::make_vars<A...>(vm, 2, objs));
+    }
+
+    static SQInteger iNewVM(HSQUIRRELVM vm) {
+        return Construct(vm, SQRAT_STD::make_tuple<HSQUIRRELVM&>(vm));
+    }
+
+    template <typename...A>
+    static SQInteger iNewVM(HSQUIRRELVM vm) {
+        vargs::VarObjects<sizeof...(A)> objs;
+        if (!vargs::get_var_objects<A...>(vm, 2, objs))
+            return SQ_ERROR;
+
+        return Construct(vm, SQRAT_STD::tuple_cat(
+          SQRAT_STD::make_tuple<HSQUIRRELVM&>(vm),
+          vargs::make_vars<A...>(vm, 2, objs)
+        ));
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Called by Sqrat to set up the instance at idx on the stack as a copy of a value of the same type
+    ///
+    /// \param vm    VM that has an instance object of the correct type at idx
+    /// \param idx   Index of the stack that the instance object is at
+    /// \param value A pointer to data of the same type as the instance object
+    ///
+    /// \return Squirrel error code
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger Copy(HSQUIRRELVM vm, SQInteger idx, const void* value) {
+        return Emplace(vm, idx, *static_cast<const C*>(value));
+    }
+
+    /// Sets up the instance at idx on the stack with an object constructed from value (see AllocatorMoveFunc)
+    template <class V>
+    static SQInteger Emplace(HSQUIRRELVM vm, SQInteger idx, V&& value) {
+        ClassData<C>* cd = ClassType<C>::getClassData(vm);
+        Block* block = GetPool(cd)->Alloc();
+        Attach(vm, idx, cd, block, new (block->storage) C(SQRAT_STD::forward<V>(value)));
+        return 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Called by Sqrat to delete an instance's data
+    ///
+    /// \param ptr  Pointer to the data contained by the instance
+    /// \param size Size of the data contained by the instance
+    ///
+    /// \return Squirrel error code
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger Delete(SQUserPointer ptr, SQInteger size) {
+        SQRAT_UNUSED(size);
+        Block* block = reinterpret_cast<Block*>(ptr);
+        OwnedInstance<C>& record = block->Record();
+        if (record.second)
+            record.second->erase(record.first);
+        if (record.first == reinterpret_cast<C*>(block->storage))
+            record.first->~C();
+        else
+            record.DeleteObject();
+        record.~OwnedInstance<C>();
+        block->pool->Free(block);
+        return 0;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Adds and releases references on objects of classes bound with RefCounted
+///
+/// \tparam C Type of class
+///
+/// \remarks
+/// Calls C::AddRef() and C::Release() by default. Specialize it for classes with other reference counting functions.
+///
+/// \remarks
+/// Copying instances from Squirrel is disabled unless the traits define a static constexpr bool allowCopy set to true,
+/// which they should only do if the copy and move constructors of C start the new object without references.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class C>
+struct RefCountTraits {
+    static void AddRef(C* ptr) { ptr->AddRef(); }
+    static void Release(C* ptr) { ptr->Release(); }
+};
+
+// Whether RefCountTraits<C> opts in to copying instances of C (see RefCountTraits)
+template<class C, class = void>
+struct ref_count_allows_copy : public SQRAT_STD::false_type {};
+
+template<class C>
+struct ref_count_allows_copy<C, void_t<decltype(RefCountTraits<C>::allowCopy)>>
+    : public SQRAT_STD::integral_constant<bool, RefCountTraits<C>::allowCopy> {};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// RefCounted is the allocator to use for Class whose objects are shared between C++ and Squirrel through an intrusive
+/// reference count (see RefCountTraits)
+///
+/// \remarks
+/// Every instance holds a reference on its object, including instances created for pointers pushed from C++, so the
+/// object lives as long as C++ or any Squirrel instance refers to it. Objects constructed from Squirrel are expected
+/// to start without references (as with boost::intrusive_ptr). Instances don't keep their identity: since each one
+/// holds its own reference, pushing the same pointer twice creates two instances and no instances map is kept.
+///
+/// \remarks
+/// Copies made for cloned instances and values pushed by copy or move must also start without references, which a
+/// defaulted copy or move constructor of C does not do as it copies the count. Cloning is therefore not allowed unless
+/// RefCountTraits<C> opts in with allowCopy.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class C>
+class RefCounted {
+
+    static void AddRef(C* ptr) {
+        RefCountTraits<C>::AddRef(ptr);
+    }
+
+    static void ReleaseRef(void* ptr) {
+        RefCountTraits<C>::Release(static_cast<C*>(ptr));
+    }
+
+public:
+
+    /// Called by Sqrat when the class is created to make pushed pointers hold a reference
+    static void InitClass(HSQUIRRELVM, ClassData<C>* cd) {
+        cd->instances.reset();
+        cd->pushAcquire = &AddRef;
+        cd->pushRelease = &Delete;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Associates a newly created instance with an object, adding a reference to it
+    ///
+    /// \param vm  VM that has an instance object of the correct type at idx
+    /// \param idx Index of the stack that the instance object is at
+    /// \param ptr Object to hold a reference on
+    ///
+    /// \remarks
+    /// This function should only need to be used when custom constructors are bound with Class::SquirrelFunc.
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static void SetInstance(HSQUIRRELVM vm, SQInteger idx, C* ptr)
+    {
+        ClassData<C>* cd = ClassType<C>::getClassData(vm);
+        if (ptr)
+            AddRef(ptr);
+        sq_setinstanceup(vm, idx, new OwnedInstance<C>(ptr, cd));
+        sq_setreleasehook(vm, idx, &Delete);
+        if (cd->instances && ptr)
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, idx, &((*cd->instances)[ptr]))));
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Called by Sqrat to set up an instance on the stack for the template class
+    ///
+    /// \param vm VM that has an instance object of the correct type at position 1 in its stack
+    ///
+    /// \return Squirrel error code
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger New(HSQUIRRELVM vm) {
+        SetInstance(vm, 1, NewC<C, SQRAT_STD::is_default_constructible<C>::value >().p);
+        return 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// following iNew functions are used only if constructors are bound via Ctor() in Sqrat::Class (safe to ignore)
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger iNew(HSQUIRRELVM vm) {
+        return New(vm);
+    }
+
+    template <typename...A>
+    static SQInteger iNew(HSQUIRRELVM vm) {
+        vargs::VarObjects<sizeof...(A)> objs;
+        if (!vargs::get_var_objects<A...>(vm, 2, objs))
+            return SQ_ERROR;
+        auto vars = vargs::make_vars<A...>(vm, 2, objs);
+        C *inst = vargs::apply_ctor<C>(vars);
+        SetInstance(vm, 1, inst);
+        return 0;
+    }
+
+    static SQInteger iNewVM(HSQUIRRELVM vm) {
+        C *inst = vargs::apply_ctor<C>(SQRAT_STD::make_tuple<HSQUIRRELVM&>(vm));
+        SetInstance(vm, 1, inst);
+        return 0;
+    }
+
+    template <typename...A>
+    static SQInteger iNewVM(HSQUIRRELVM vm) {
+        vargs::VarObjects<sizeof...(A)> objs;
+        if (!vargs::get_var_objects<A...>(vm, 2, objs))
+            return SQ_ERROR;
+
+        auto args = SQRAT_STD::tuple_cat(
+          SQRAT_STD::make_tuple<HSQUIRRELVM&>(vm),
+          vargs::make_vars<A...>(vm, 2, objs)
+        );
+
+        C *inst = vargs::apply_ctor<C>(args);
+        SetInstance(vm, 1, inst);
+        return 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Called by Sqrat to set up the instance at idx on the stack as a copy of a value of the same type
+    ///
+    /// \param vm    VM that has an instance object of the correct type at idx
+    /// \param idx   Index of the stack that the instance object is at
+    /// \param value A pointer to data of the same type as the instance object
+    ///
+    /// \return Squirrel error code
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger Copy(HSQUIRRELVM vm, SQInteger idx, const void* value) {
+        if constexpr (ref_count_allows_copy<C>::value && SQRAT_STD::is_copy_constructible<C>::value)
+            return Emplace(vm, idx, *static_cast<const C*>(value));
+        else {
+            SQRAT_UNUSED(idx);
+            SQRAT_UNUSED(value);
+            return sqstd_throwerrorf(vm, _SC("Cloning of %s is not allowed"), ClassType<C>::ClassName().c_str());
+        }
+    }
+
+    /// Sets up the instance at idx on the stack with an object constructed from value (see AllocatorMoveFunc), or fails like Copy if the
+    /// class doesn't allow copies
+    template <class V>
+    static SQInteger Emplace(HSQUIRRELVM vm, SQInteger idx, V&& value) {
+        if constexpr (ref_count_allows_copy<C>::value) {
+            SetInstance(vm, idx, new C(SQRAT_STD::forward<V>(value)));
+            return 0;
+        }
+        else
+            return Copy(vm, idx, &value);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Called by Sqrat to release the reference held by an instance
+    ///
+    /// \param ptr  Pointer to the data contained by the instance
+    /// \param size Size of the data contained by the instance
+    ///
+    /// \return Squirrel error code
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static SQInteger Delete(SQUserPointer ptr, SQInteger size) {
+        SQRAT_UNUSED(size);
+        OwnedInstance<C>* instance = reinterpret_cast<OwnedInstance<C>*>(ptr);
+        if (instance->second)
+            instance->second->erase(instance->first);
+        if (instance->first)
+            instance->heap->Destroy(instance->first, &ReleaseRef);
         delete instance;
         return 0;
     }
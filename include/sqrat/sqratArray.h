@@ -88,12 +88,13 @@ public:
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     template<class F>
     ArrayBase& Func(const SQInteger index, F method) {
-        BindFunc<F>(index, method, SqGlobalThunk<F>(), 1+SqGetArgCount<F>());
+        BindFunc<F>(index, method, SqGlobalThunk<F, ArgCheck::Unmasked>(), 1+SqGetArgCount<F>(), false,
+                    SqGetTypeMask<F, _SC('.')>());
         return *this;
     }
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    /// Returns the element at a given index
+    /// Returns a copy of the element at a given index
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     template <typename T>
     T GetValue(int index)
@@ -106,9 +107,9 @@ public:
             return T();
         }
 
-        Var<T> element(vm, -1);
+        T element = Var<T>(vm, -1).value; // copied while the element is still on the stack
         sq_pop(vm, 2);
-        return element.value;
+        return element;
     }
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
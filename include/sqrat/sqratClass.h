@@ -60,15 +60,6 @@ template<class C> struct InstanceToString;
 template<class C, class A = DefaultAllocator<C> >
 class Class : public Object
 {
-private:
-
-    static SQInteger cleanup_hook(SQUserPointer ptr, SQInteger size) {
-        SQRAT_UNUSED(size);
-        ClassData<C>** ud = reinterpret_cast<ClassData<C>**>(ptr);
-        delete *ud;
-        return 0;
-    }
-
 public:
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -87,30 +78,16 @@ public:
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     Class(HSQUIRRELVM v, string && className, bool createClass = true) : Object(v, false) {
         if (createClass && !ClassType<C>::hasClassData(v)) {
-            sq_pushregistrytable(v);
-            sq_pushuserpointer(v, ClassesRegistryTable::slotKey());
-            if (SQ_FAILED(sq_rawget(v, -2))) {
-                sq_newtable(v);
-                sq_pushuserpointer(v, ClassesRegistryTable::slotKey());
-                sq_push(v, -2);
-                sq_rawset(v, -4);
-            }
-            sq_pushuserpointer(v, ClassData<C>::type_id());
-            ClassData<C>** ud = reinterpret_cast<ClassData<C>**>(sq_newuserdata(v, sizeof(ClassData<C>*)));
-            *ud = new ClassData<C>;
-            sq_setreleasehook(v, -1, &cleanup_hook);
-            sq_rawset(v, -3);
-            sq_pop(v, 2);
-
-            ClassData<C>* cd = *ud;
+            ClassData<C>* cd = new ClassData<C>;
+            VMClassData::GetOrCreate(v)->Add(cd);
 
             if (ClassType<C>::getStaticClassData().expired()) {
-                cd->staticData.reset(new StaticClassData<C, void>);
+                ClassType<C>::setStaticClassData(cd, new StaticClassData<C, void>);
                 cd->staticData->copyFunc  = &A::Copy;
+                cd->staticData->moveFunc  = AllocatorMoveFunc<C, A>::Get();
                 cd->staticData->className = SQRAT_STD::move(className);
                 cd->staticData->baseClass = NULL;
-
-                ClassType<C>::getStaticClassData() = cd->staticData;
+                cd->staticData->InitHierarchy();
             } else {
                 cd->staticData = ClassType<C>::getStaticClassData().lock();
             }
@@ -298,48 +275,135 @@ public:
     /// Binds a class function
     template<class F>
     Class& Func(const SQChar* name, F method) {
-        BindFunc(name, method, SqMemberFunc<C, F>(), 1+SqGetArgCount<F>());
+        BindFunc(name, method, SqMemberFunc<C, F, ArgCheck::Unmasked>(), 1+SqGetArgCount<F>(), false,
+                 SqGetTypeMask<F, _SC('x')>());
         return *this;
     }
 
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Binds a class function known at compile time (e.g. Func<&C::method>("method"))
+    ///
+    /// \remarks
+    /// The function is called directly by its thunk: no free variable is stored and the call can be inlined.
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<auto F>
+    Class& Func(const SQChar* name) {
+        return SquirrelFunc(name, SqMemberFuncDirect<C, F, ArgCheck::Unmasked>(), 1+SqGetArgCount<decltype(F)>(),
+                            SqGetTypeMask<decltype(F), _SC('x')>());
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Binds a class function called only by trusted scripts
+    ///
+    /// \remarks
+    /// Only the number of arguments is checked (by the VM): types of the arguments and of the instance are not validated,
+    /// unless SQRAT_VALIDATE_UNCHECKED is set (the default in debug builds). Passing a wrong type is undefined behavior.
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<class F>
+    Class& FuncUnchecked(const SQChar* name, F method) {
+        BindFunc(name, method, SqMemberFunc<C, F, ArgCheck::None>(), 1+SqGetArgCount<F>());
+        return *this;
+    }
+
+    /// Binds a class function known at compile time called only by trusted scripts (see FuncUnchecked and Func<F>)
+    template<auto F>
+    Class& FuncUnchecked(const SQChar* name) {
+        return SquirrelFunc(name, SqMemberFuncDirect<C, F, ArgCheck::None>(), 1+SqGetArgCount<decltype(F)>());
+    }
+
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     /// Binds a class function with overloading enabled
     ///
     /// \remarks
     /// Overloading in this context means to allow the function name to be used with functions
-    /// of a different number of arguments. This definition differs from others (e.g. C++'s).
+    /// of a different number of arguments, or of different argument types (checked by Var<T>::check_type,
+    /// trying derived classes before their bases). Binding an identical signature replaces the function.
     ///
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     template<class F>
     Class& Overload(const SQChar* name, F method) {
-        BindOverload(name, method, SqMemberOverloadedFunc<C, F>(), SqOverloadFunc<F>(), SqGetArgCount<F>());
+        BindOverload(name, method, SqMemberOverloadedFunc<C, F>(), SqOverloadFunc<F>(), SqGetArgCount<F>(), false,
+                     SqGetOverloadSignature<F>());
+        return *this;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Binds a class function taking any number of arguments, e.g. void Log(ArgSpan args)
+    ///
+    /// \remarks
+    /// The function gets a view of the arguments after the instance, which are decoded only when accessed (see ArgSpan).
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<class F>
+    Class& VarargFunc(const SQChar* name, F method) {
+        BindFunc(name, method, SqMemberVarargFunc<C, F>(), -1, false, _SC("x"));
+        return *this;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Binds a class function returning a class, which can also be called with an extra destination instance
+    ///
+    /// \remarks
+    /// When called as obj.name(args..., dest), the result is assigned to the object of dest and dest is returned,
+    /// so no new instance is allocated for the result. Without dest it behaves like Class::Func.
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<class F>
+    Class& FuncDest(const SQChar* name, F method) {
+        BindFunc(name, method, SqMemberFuncDest<C, F>(), 0);
         return *this;
     }
 
     /// Binds a global function as a class function
     template<class F>
     Class& GlobalFunc(const SQChar* name, F method) {
-        BindFunc(name, method, SqMemberGlobalThunk<F>(), SqGetArgCount<F>());
+        BindFunc(name, method, SqMemberGlobalThunk<F, ArgCheck::Unmasked>(), SqGetArgCount<F>(), false,
+                 SqGetTypeMask<F>());
+        return *this;
+    }
+
+    /// Binds a global function known at compile time as a class function (see Func<F>)
+    template<auto F>
+    Class& GlobalFunc(const SQChar* name) {
+        return SquirrelFunc(name, SqMemberGlobalThunkDirect<F, ArgCheck::Unmasked>(), SqGetArgCount<decltype(F)>(),
+                            SqGetTypeMask<decltype(F)>());
+    }
+
+    /// Binds a global function returning a class as a class function, accepting an extra destination instance (see Class::FuncDest)
+    template<class F>
+    Class& GlobalFuncDest(const SQChar* name, F method) {
+        BindFunc(name, method, SqMemberGlobalThunkDest<F>(), 0);
         return *this;
     }
 
     /// Binds a static class function
     template<class F>
     Class& StaticFunc(const SQChar* name, F method) {
-        BindFunc(name, method, SqGlobalThunk<F>(), 1+SqGetArgCount<F>());
+        BindFunc(name, method, SqGlobalThunk<F, ArgCheck::Unmasked>(), 1+SqGetArgCount<F>(), false,
+                 SqGetTypeMask<F, _SC('.')>());
         return *this;
     }
 
+    /// Binds a static class function known at compile time (see Func<F>)
+    template<auto F>
+    Class& StaticFunc(const SQChar* name) {
+        return SquirrelFunc(name, SqGlobalThunkDirect<F, ArgCheck::Unmasked>(), 1+SqGetArgCount<decltype(F)>(),
+                            SqGetTypeMask<decltype(F), _SC('.')>());
+    }
+
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     /// Binds a global function as a class function with overloading enabled
     ///
     /// \remarks
     /// Overloading in this context means to allow the function name to be used with functions
-    /// of a different number of arguments. This definition differs from others (e.g. C++'s).
+    /// of a different number of arguments or argument types (see Overload).
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     template<class F>
     Class& GlobalOverload(const SQChar* name, F method) {
-        BindOverload(name, method, SqMemberGlobalOverloadedFunc<F>(), SqOverloadFunc<F>(), SqGetArgCount<F>() - 1);
+        BindOverload(name, method, SqMemberGlobalOverloadedFunc<F>(), SqOverloadFunc<F>(), SqGetArgCount<F>() - 1, false,
+                     SqGetOverloadSignature<F, 1>());
         return *this;
     }
 
@@ -348,11 +412,12 @@ public:
     ///
     /// \remarks
     /// Overloading in this context means to allow the function name to be used with functions
-    /// of a different number of arguments. This definition differs from others (e.g. C++'s).
+    /// of a different number of arguments or argument types (see Overload).
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     template<class F>
     Class& StaticOverload(const SQChar* name, F method) {
-        BindOverload(name, method, SqGlobalOverloadedFunc<F>(), SqOverloadFunc<F>(), SqGetArgCount<F>());
+        BindOverload(name, method, SqGlobalOverloadedFunc<F>(), SqOverloadFunc<F>(), SqGetArgCount<F>(), false,
+                     SqGetOverloadSignature<F>());
         return *this;
     }
 
@@ -414,6 +479,12 @@ protected:
         return ClassType<C>::CopyFunc()(vm, 1, other.value);
     }
 
+    // Stamps the typetag of C on Squirrel classes that extend it, so that their instances resolve to C without walking the class chain
+    static SQInteger ClassInherited(HSQUIRRELVM vm) {
+        sq_settypetag(vm, 1, ClassType<C>::getStaticClassDataPtr());
+        return 0;
+    }
+
     // Initialize the required data structure for the class
     void InitClass(ClassData<C>* cd) {
         cd->instances.reset(new InstancesMap<C>);
@@ -426,7 +497,7 @@ protected:
 
         // add the default constructor
         sq_pushstring(vm, _SC("constructor"), -1);
-        sq_newclosure(vm, &A::New, 0);
+        sq_newclosure(vm, &Class<C, A>::Constructor, 0);
         SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, false)));
 
         // add the set table (static)
@@ -474,6 +545,11 @@ protected:
         sq_newclosure(vm, &Class::ClassCloned, 0);
         SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, false)));
 
+        // add _inherited
+        sq_pushstring(vm, _SC("_inherited"), -1);
+        sq_newclosure(vm, &Class::ClassInherited, 0);
+        SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, false)));
+
         // add _tostring
         sq_pushstring(vm, _SC("_tostring"), -1);
         sq_newclosure(vm, InstanceToString<C>::Format, 0);
@@ -481,6 +557,8 @@ protected:
 
         // pop the class
         sq_pop(vm, 1);
+
+        AllocatorInitClass<C, A>::Init(vm, cd);
     }
 
     // Helper function used to bind getters and setters
@@ -503,37 +581,31 @@ protected:
         sq_pop(vm, 1);
     }
 
+    // Default constructor of the class: runs the constructor bound with Ctor for the number of arguments in the same
+    // native call, or the allocator's New if there are none
+    static SQInteger Constructor(HSQUIRRELVM vm) {
+        const vector<SQFUNCTION>& constructors = ClassType<C>::getClassData(vm)->constructors;
+        if (constructors.empty())
+            return A::New(vm);
+        SQInteger argCount = sq_gettop(vm) - 1;
+        if (argCount >= SQInteger(constructors.size()) || !constructors[argCount])
+            return sq_throwerror(vm, _SC("wrong number of parameters"));
+        return constructors[argCount](vm);
+    }
+
     // constructor binding
     Class& BindConstructor(SQFUNCTION method, SQInteger nParams, const SQChar *name = 0) {
-        SQFUNCTION overload = SqOverloadFunc<SQFUNCTION>();
-        bool alternative_global = false;
-        if (name == 0)
-            name = _SC("constructor");
-        else alternative_global = true;
-        string overloadName = SqOverloadName::Get(name, nParams);
-
-        if (!alternative_global )
-        {
-            // push the class
-            sq_pushobject(vm, ClassType<C>::getClassData(vm)->classObj);
-        }
-        else
-        {
-            // the containing environment is the root table??
-            sq_pushroottable(vm);
+        if (name == 0) {
+            vector<SQFUNCTION>& constructors = ClassType<C>::getClassData(vm)->constructors;
+            if (nParams >= SQInteger(constructors.size()))
+                constructors.resize(nParams + 1);
+            constructors[nParams] = method;
+            return *this;
         }
 
-        // Bind overload handler
-        sq_pushstring(vm, name, -1);
-        sq_pushstring(vm, name, -1); // function name is passed as a free variable
-        sq_newclosure(vm, overload, 1);
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, false)));
-
-        // Bind overloaded allocator function
-        sq_pushstring(vm, overloadName.c_str(), -1);
-        sq_newclosure(vm, method, 0);
-        sq_setparamscheck(vm,nParams + 1,NULL);
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, false)));
+        // the containing environment is the root table??
+        sq_pushroottable(vm);
+        SqBindOverload(vm, name, method, shared_ptr<void>(), SqOverloadFunc<SQFUNCTION>(), nParams, false, SqOverloadSignature());
         sq_pop(vm, 1);
         return *this;
     }
@@ -594,15 +666,6 @@ class DerivedClass : public Class<C, A>
 {
   using Class<C, A>::vm;
 
-private:
-
-    static SQInteger cleanup_hook(SQUserPointer ptr, SQInteger size) {
-        SQRAT_UNUSED(size);
-        ClassData<C>** ud = reinterpret_cast<ClassData<C>**>(ptr);
-        delete *ud;
-        return 0;
-    }
-
 public:
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -623,31 +686,17 @@ public:
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     DerivedClass(HSQUIRRELVM v, string && className) : Class<C, A>(v, string(), false) {
         if (!ClassType<C>::hasClassData(v)) {
-            sq_pushregistrytable(v);
-            sq_pushuserpointer(v, ClassesRegistryTable::slotKey());
-            if (SQ_FAILED(sq_rawget(v, -2))) {
-                sq_newtable(v);
-                sq_pushuserpointer(v, ClassesRegistryTable::slotKey());
-                sq_push(v, -2);
-                sq_rawset(v, -4);
-            }
-            sq_pushuserpointer(v, ClassData<C>::type_id());
-            ClassData<C>** ud = reinterpret_cast<ClassData<C>**>(sq_newuserdata(v, sizeof(ClassData<C>*)));
-            *ud = new ClassData<C>;
-            sq_setreleasehook(v, -1, &cleanup_hook);
-            sq_rawset(v, -3);
-            sq_pop(v, 2);
+            ClassData<C>* cd = new ClassData<C>;
+            VMClassData::GetOrCreate(v)->Add(cd);
 
             ClassData<B>* bd = ClassType<B>::getClassData(v);
-            ClassData<C>* cd = *ud;
-
             if (ClassType<C>::getStaticClassData().expired()) {
-                cd->staticData.reset(new StaticClassData<C, B>);
+                ClassType<C>::setStaticClassData(cd, new StaticClassData<C, B>);
                 cd->staticData->copyFunc  = &A::Copy;
+                cd->staticData->moveFunc  = AllocatorMoveFunc<C, A>::Get();
                 cd->staticData->className = SQRAT_STD::move(className);
                 cd->staticData->baseClass = bd->staticData.get();
-
-                ClassType<C>::getStaticClassData() = cd->staticData;
+                cd->staticData->InitHierarchy();
             } else {
                 cd->staticData = ClassType<C>::getStaticClassData().lock();
             }
@@ -677,7 +726,7 @@ protected:
 
         // add the default constructor
         sq_pushstring(vm, _SC("constructor"), -1);
-        sq_newclosure(vm, &A::New, 0);
+        sq_newclosure(vm, &Class<C, A>::Constructor, 0);
         SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, false)));
 
         // clone the base classes set table (static)
@@ -729,6 +778,11 @@ protected:
         sq_newclosure(vm, &Class<C, A>::ClassCloned, 0);
         SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, false)));
 
+        // add _inherited
+        sq_pushstring(vm, _SC("_inherited"), -1);
+        sq_newclosure(vm, &Class<C, A>::ClassInherited, 0);
+        SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, false)));
+
         // add _tostring
         sq_pushstring(vm, _SC("_tostring"), -1);
         sq_newclosure(vm, InstanceToString<C>::Format, 0);
@@ -736,6 +790,8 @@ protected:
 
         // pop the class
         sq_pop(vm, 1);
+
+        AllocatorInitClass<C, A>::Init(vm, cd);
     }
 };
 
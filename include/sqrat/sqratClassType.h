@@ -30,6 +30,7 @@
 #define _SQRAT_CLASSTYPE_H_
 
 #include <squirrel.h>
+#include <atomic>
 #include "sqratUtil.h"
 
 namespace Sqrat
@@ -39,13 +40,28 @@ namespace Sqrat
 // The copy function for a class
 typedef SQInteger (*COPYFUNC)(HSQUIRRELVM, SQInteger, const void*);
 
+// The move function for a class (moves the object into the instance, which is used for temporaries returned by value)
+typedef SQInteger (*MOVEFUNC)(HSQUIRRELVM, SQInteger, void*);
+
+// Number of ancestors kept in the display of AbstractStaticClassData (deeper ancestors are found by walking baseClass)
+#ifndef SQRAT_CLASS_DISPLAY_SIZE
+#define SQRAT_CLASS_DISPLAY_SIZE 16
+#endif
+
 // Every Squirrel class instance made by Sqrat has its type tag set to a AbstractStaticClassData object that is unique per C++ class
 struct AbstractStaticClassData {
-    AbstractStaticClassData() {}
+    AbstractStaticClassData() : baseClass(NULL), copyFunc(NULL), moveFunc(NULL), depth(0), baseOffset(0), fixedBaseOffset(true), fixedOffsets(true) {}
     virtual ~AbstractStaticClassData() {}
     virtual SQUserPointer Cast(SQUserPointer ptr, SQUserPointer classType) = 0;
     virtual bool PushInstance(HSQUIRRELVM vm, void *ptr) = 0;
 
+    // Return the shared_ptr owning the object of an instance made by ClassType::PushSharedInstance, or NULL for other instances
+    // (up and hook are the userpointer and the release hook of the instance, the last argument only selects the shared_ptr kind)
+    virtual const std::shared_ptr<void>* GetSharedOwner(SQUserPointer up, SQRELEASEHOOK hook, const std::shared_ptr<void>*) = 0;
+#if defined(SQRAT_HAS_EASTL)
+    virtual const eastl::shared_ptr<void>* GetSharedOwner(SQUserPointer up, SQRELEASEHOOK hook, const eastl::shared_ptr<void>*) = 0;
+#endif
+
     static AbstractStaticClassData* FromObject(const HSQOBJECT *obj) {
         AbstractStaticClassData* actualType = nullptr;
         if (SQ_FAILED(sq_getobjtypetag(obj, (SQUserPointer*)&actualType)))
@@ -53,14 +69,86 @@ struct AbstractStaticClassData {
         return actualType;
     }
 
+    // Changes whenever a class display is built or released, so that what is derived from class depths can be refreshed
+    static unsigned& HierarchyVersion() {
+        static unsigned version = 0;
+        return version;
+    }
+
+    // Builds the ancestor display and upcast offsets from baseClass (which must be set and have its own display built already)
+    void InitHierarchy() {
+        ++HierarchyVersion();
+        depth = baseClass ? baseClass->depth + 1 : 0;
+        fixedOffsets = baseClass ? (baseClass->fixedOffsets && fixedBaseOffset) : true;
+        for (int i = 0; i < depth && i < SQRAT_CLASS_DISPLAY_SIZE; ++i) {
+            ancestors[i] = baseClass->ancestors[i];
+            ancestorOffsets[i] = baseOffset + baseClass->ancestorOffsets[i];
+        }
+        if (depth < SQRAT_CLASS_DISPLAY_SIZE) {
+            ancestors[depth] = this;
+            ancestorOffsets[depth] = 0;
+        }
+    }
+
+    // Converts a pointer to this class into a pointer to the ancestor cls (which must be this class or one of its bases)
+    SQUserPointer Upcast(SQUserPointer ptr, AbstractStaticClassData* cls) {
+        if (cls == this || ptr == NULL)
+            return ptr;
+        if (fixedOffsets && cls->depth < SQRAT_CLASS_DISPLAY_SIZE)
+            return static_cast<char*>(ptr) + ancestorOffsets[cls->depth];
+        return Cast(ptr, cls);
+    }
+
+    // Returns true if this class is cls or derives from it
+    bool IsSubclassOf(const AbstractStaticClassData* cls) const {
+        if (!cls || cls->depth > depth)
+            return false;
+        if (cls->depth < SQRAT_CLASS_DISPLAY_SIZE)
+            return ancestors[cls->depth] == cls;
+        const AbstractStaticClassData* actual = this;
+        while (actual->depth > cls->depth)
+            actual = actual->baseClass;
+        return actual == cls;
+    }
+
     AbstractStaticClassData* baseClass;
     string                   className;
     COPYFUNC                 copyFunc;
+    MOVEFUNC                 moveFunc; // NULL if the allocator can't move, copyFunc is used instead
+
+    int                      depth;                                // number of ancestors
+    AbstractStaticClassData* ancestors[SQRAT_CLASS_DISPLAY_SIZE]; // ancestors[i] is the ancestor at depth i, ancestors[depth] is this class
+
+    ptrdiff_t                baseOffset;                                 // pointer offset of the direct base class subobject
+    bool                     fixedBaseOffset;                            // false if the base is virtual (offset is only known at runtime)
+    bool                     fixedOffsets;                               // true if all ancestorOffsets are valid
+    ptrdiff_t                ancestorOffsets[SQRAT_CLASS_DISPLAY_SIZE]; // pointer offset from this class to ancestors[i]
+};
+
+// Constant pointer offset of the base class B subobject in C (only exists for non-virtual bases, which can be downcast with static_cast)
+template<class C, class B, class = void>
+struct UpcastOffset {
+    static const bool fixed = false;
+    static ptrdiff_t get() { return 0; }
+};
+
+template<class C, class B>
+struct UpcastOffset<C, B, void_t<decltype(static_cast<C*>(SQRAT_STD::declval<B*>()))>> {
+    static const bool fixed = true;
+    static ptrdiff_t get() {
+        C* ptr = reinterpret_cast<C*>(uintptr_t(0x10000)); // any suitably aligned non-null address, never dereferenced
+        return reinterpret_cast<char*>(static_cast<B*>(ptr)) - reinterpret_cast<char*>(ptr);
+    }
 };
 
 // StaticClassData keeps track of the nearest base class B and the class associated with itself C in order to cast C++ pointers to the right base class
 template<class C, class B>
 struct StaticClassData : public AbstractStaticClassData {
+    StaticClassData() {
+        baseOffset = UpcastOffset<C, B>::get();
+        fixedBaseOffset = UpcastOffset<C, B>::fixed;
+    }
+
     virtual SQUserPointer Cast(SQUserPointer ptr, SQUserPointer classType) override {
         if (classType != this) {
             ptr = baseClass->Cast(static_cast<B*>(static_cast<C*>(ptr)), classType);
@@ -69,25 +157,300 @@ struct StaticClassData : public AbstractStaticClassData {
     }
 
     virtual bool PushInstance(HSQUIRRELVM vm, void *ptr) override;
+
+    virtual const std::shared_ptr<void>* GetSharedOwner(SQUserPointer up, SQRELEASEHOOK hook, const std::shared_ptr<void>*) override;
+#if defined(SQRAT_HAS_EASTL)
+    virtual const eastl::shared_ptr<void>* GetSharedOwner(SQUserPointer up, SQRELEASEHOOK hook, const eastl::shared_ptr<void>*) override;
+#endif
 };
 
+#if defined(SQRAT_HAS_SKA_HASH_MAP) || defined(SQRAT_STD_INSTANCES_MAP)
 template<class C> using InstancesMap = class_hash_map<C*, HSQOBJECT>;
+#else
+template<class C> using InstancesMap = ptr_hash_map<C*, HSQOBJECT>;
+#endif
 template<class C> using InstancePtrAndMap = SQRAT_STD::pair<C*, shared_ptr<InstancesMap<C>> >;
 
-// Every Squirrel class object created by Sqrat in every VM has its own unique ClassData object stored in the registry table of the VM
+#if defined(SQRAT_CLASS_STATS)
+// Native memory accounting of the instances of a class in a VM. Only objects kept alive by Squirrel instances are counted
+// (objects created by the allocator, and objects pushed with shared ownership), pointers pushed as plain references are not.
+// Define SQRAT_CLASS_STATS to collect it, otherwise instances don't count anything.
+struct ClassStats {
+    string className;
+    size_t objectSize;  // sizeof(C)
+    size_t live;        // objects currently kept alive by instances
+    size_t peak;        // highest value of live
+    size_t allocations; // objects ever attached to instances
+    size_t frees;       // objects released by instances
+    size_t nativeBytes; // footprint of the live objects as reported by NativeFootprint
+
+    size_t LiveBytes() const { return live * objectSize; }
+    size_t PeakBytes() const { return peak * objectSize; }
+    size_t AllocatedBytes() const { return allocations * objectSize; }
+};
+#endif
+
+// Per-VM state shared by the ClassHeaps of a VM: the queue of native objects whose destruction is deferred (see SetDeferredDestruction).
+// Owned by the VMClassData of the VM and by its ClassHeaps, which may outlive it when the VM is closed.
+struct NativeHeap {
+    struct Pending {
+        void* object;
+        void (*destroy)(void*);
+    };
+
+    vector<Pending> pending;
+    size_t head;           // pending[head..] are still to be destroyed
+    bool deferDestruction; // release hooks queue objects instead of destroying them
+    size_t refs;
+
+#if defined(SQRAT_CLASS_STATS)
+    HSQUIRRELVM vm;         // VM the heap was created for, passed to the threshold callback
+    size_t nativeBytes;     // footprint of the objects kept alive by instances of all classes
+    size_t threshold;       // thresholdCallback is called when nativeBytes reaches it
+    bool thresholdReached;  // set until nativeBytes drops below threshold again
+    void (*thresholdCallback)(HSQUIRRELVM vm, size_t nativeBytes, void* userData);
+    void* thresholdUserData;
+
+    explicit NativeHeap(HSQUIRRELVM v = NULL) : head(0), deferDestruction(false), refs(1), vm(v), nativeBytes(0),
+        threshold(0), thresholdReached(false), thresholdCallback(NULL), thresholdUserData(NULL) {}
+#else
+    explicit NativeHeap(HSQUIRRELVM = NULL) : head(0), deferDestruction(false), refs(1) {}
+#endif
+
+#if defined(SQRAT_CLASS_STATS)
+    void AddBytes(size_t bytes) {
+        nativeBytes += bytes;
+        if (thresholdCallback && !thresholdReached && nativeBytes >= threshold) {
+            thresholdReached = true;
+            thresholdCallback(vm, nativeBytes, thresholdUserData);
+        }
+    }
+
+    void RemoveBytes(size_t bytes) {
+        nativeBytes -= bytes;
+        if (nativeBytes < threshold)
+            thresholdReached = false;
+    }
+#endif
+
+    void Destroy(void* object, void (*destroy)(void*)) {
+        if (deferDestruction) {
+            Pending p = { object, destroy };
+            pending.push_back(p);
+        }
+        else
+            destroy(object);
+    }
+
+    // Destroys up to budget queued objects in release order, returns the number destroyed
+    size_t DestroyPending(size_t budget) {
+        size_t count = 0;
+        while (count < budget && head < pending.size()) {
+            Pending p = pending[head++]; // destructors may queue more objects, which can reallocate pending
+            p.destroy(p.object);
+            ++count;
+        }
+        if (head == pending.size()) {
+            pending.clear();
+            head = 0;
+        }
+        return count;
+    }
+
+    void Release() {
+        if (!--refs)
+            delete this;
+    }
+};
+
+// Heap of the objects kept alive by the instances of a class (and counters behind ClassStats), owned by the ClassData of the
+// class and by those instances, as instances may be released after the class data when the VM is closed (VMs are
+// single-threaded so the reference count is not atomic)
+struct ClassHeap {
+#if defined(SQRAT_CLASS_STATS)
+    size_t objectSize;
+    size_t live;
+    size_t peak;
+    size_t allocations;
+    size_t frees;
+    size_t nativeBytes;
+#endif
+    size_t refs;
+    NativeHeap* native; // heap of the VM, set when the class is registered in it
+
+#if defined(SQRAT_CLASS_STATS)
+    explicit ClassHeap(size_t size) : objectSize(size), live(0), peak(0), allocations(0), frees(0), nativeBytes(0), refs(1), native(NULL) {}
+#else
+    explicit ClassHeap(size_t) : refs(1), native(NULL) {}
+#endif
+
+    ~ClassHeap() {
+        if (native)
+            native->Release();
+    }
+
+    void Attach(NativeHeap* heap) {
+        SQRAT_ASSERT(!native);
+        native = heap;
+        ++native->refs;
+    }
+
+    // Destroys an object released by an instance, or queues it if the VM defers destruction
+    void Destroy(void* object, void (*destroy)(void*)) {
+        if (native)
+            native->Destroy(object, destroy);
+        else
+            destroy(object);
+    }
+
+#if defined(SQRAT_CLASS_STATS)
+    void Allocated(size_t bytes) {
+        ++refs;
+        ++allocations;
+        if (++live > peak)
+            peak = live;
+        nativeBytes += bytes;
+        if (native)
+            native->AddBytes(bytes);
+    }
+
+    void Freed(size_t bytes) {
+        --live;
+        ++frees;
+        nativeBytes -= bytes;
+        if (native)
+            native->RemoveBytes(bytes);
+        Release();
+    }
+#endif
+
+    void Acquire() {
+        ++refs;
+    }
+
+    void Release() {
+        if (!--refs)
+            delete this;
+    }
+};
+
+// Common base of ClassData so that the per-VM class table can own ClassData objects of any type
+struct AbstractClassData {
+    explicit AbstractClassData(size_t objectSize) : heap(new ClassHeap(objectSize)) {}
+    virtual ~AbstractClassData() { heap->Release(); }
+
+    shared_ptr<AbstractStaticClassData> staticData;
+    ClassHeap* heap; // native memory accounting of the class in the VM
+
+#if defined(SQRAT_CLASS_STATS)
+    ClassStats GetStats() const {
+        ClassStats stats;
+        stats.className = staticData ? staticData->className : string();
+        stats.objectSize = heap->objectSize;
+        stats.live = heap->live;
+        stats.peak = heap->peak;
+        stats.allocations = heap->allocations;
+        stats.frees = heap->frees;
+        stats.nativeBytes = heap->nativeBytes;
+        return stats;
+    }
+#endif
+};
+
+// Every Squirrel class object created by Sqrat in every VM has its own unique ClassData object stored in the VMClassData of the VM
 template<class C>
-struct ClassData {
+struct ClassData : public AbstractClassData {
+    ClassData() : AbstractClassData(sizeof(C)) {}
+
     HSQOBJECT classObj;
     HSQOBJECT getTable;
     HSQOBJECT setTable;
-    shared_ptr<InstancesMap<C>> instances;
-    shared_ptr<AbstractStaticClassData> staticData;
+    shared_ptr<InstancesMap<C>> instances; // null if the class doesn't track instance identity (see UntrackedInstances)
+    shared_ptr<void> allocatorData; // per-VM state of the class allocator (e.g. the PoolAllocator pool), if it needs any
+    vector<SQFUNCTION> constructors; // constructors bound with Class::Ctor indexed by number of arguments (the allocator's New if none)
+
+    // Set by allocators that share ownership of the native objects (see RefCounted): pointers pushed from C++ are passed
+    // to pushAcquire, and pushRelease is used as the release hook of their instances (which get an OwnedInstance record)
+    // instead of ClassType::DeleteInstance
+    void (*pushAcquire)(C*) = nullptr;
+    SQRELEASEHOOK pushRelease = nullptr;
 
-    static int type_id_helper;
+    static int type_id_helper; // dense class id used to index VMClassData::classes (0 until the class is bound for the first time)
     static void* type_id() { return &type_id_helper; }
+
+    // Raw pointer to the object owned by staticData, valid while the class is bound in at least one VM.
+    // Set when the static data is created and reset by its deleter, so that type checks can avoid weak_ptr::lock()
+    static AbstractStaticClassData* static_data;
 };
 
 template<class C> int ClassData<C>::type_id_helper = 0;
+template<class C> AbstractStaticClassData* ClassData<C>::static_data = nullptr;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Native memory footprint of an object of a bound class, counted in the native bytes of its VM while an instance keeps it alive
+///
+/// \remarks
+/// Defaults to sizeof(C). Specialize it for classes owning more memory (e.g. buffers) so that hosts can pace garbage
+/// collection on the actual memory use (see SetNativeMemoryThreshold). It is evaluated once when the object is attached,
+/// and only if SQRAT_CLASS_STATS is defined.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class C>
+struct NativeFootprint {
+    static size_t Get(const C&) { return sizeof(C); }
+};
+
+// Instance record of the objects kept alive by an instance, which are destroyed through (and counted in) the ClassHeap of
+// the class
+template<class C>
+struct OwnedInstance : public InstancePtrAndMap<C> {
+    ClassHeap* heap;
+#if defined(SQRAT_CLASS_STATS)
+    size_t bytes; // footprint counted for the object
+
+    OwnedInstance(C* ptr, ClassData<C>* cd) : InstancePtrAndMap<C>(ptr, cd->instances), heap(cd->heap), bytes(0) {
+        if (ptr) {
+            bytes = NativeFootprint<C>::Get(*ptr);
+            heap->Allocated(bytes);
+        }
+    }
+
+    ~OwnedInstance() {
+        if (this->first)
+            heap->Freed(bytes);
+    }
+#else
+    OwnedInstance(C* ptr, ClassData<C>* cd) : InstancePtrAndMap<C>(ptr, cd->instances), heap(cd->heap) {
+        if (ptr)
+            heap->Acquire();
+    }
+
+    ~OwnedInstance() {
+        if (this->first)
+            heap->Release();
+    }
+#endif
+
+    // Deletes the object, which was allocated with the new operator (deferred if the VM defers destruction)
+    void DeleteObject() {
+        if (this->first)
+            heap->Destroy(this->first, &DeleteNative);
+    }
+
+    static void DeleteNative(void* ptr) {
+        delete static_cast<C*>(ptr);
+    }
+
+    OwnedInstance(const OwnedInstance&) = delete;
+    OwnedInstance& operator=(const OwnedInstance&) = delete;
+};
+
+// Instance record of objects pushed with ClassType::PushSharedInstance, which also keeps the object alive
+template<class C, class Owner>
+struct SharedInstance : public OwnedInstance<C> {
+    Owner owner; // shared_ptr<void> of the same kind as the pushed one, sharing its control block
+
+    SharedInstance(C* ptr, ClassData<C>* cd, const Owner& o) : OwnedInstance<C>(ptr, cd), owner(o) {}
+};
 
 // Lookup static class data by type_info rather than a template because C++ cannot export generic templates
 struct IntPtrHash { size_t operator()(const void *p) const { return uintptr_t(p) >> 2; } };
@@ -96,10 +459,13 @@ class _ClassType_helper
 {
 public:
     static class_hash_map<const void*, weak_ptr<AbstractStaticClassData>, IntPtrHash> data;
+    static int lastClassId;
     static weak_ptr<AbstractStaticClassData>& _getStaticClassData(const void* type) { return data[type]; }
 };
 template<typename T>
 class_hash_map<const void*, weak_ptr<AbstractStaticClassData>, IntPtrHash> _ClassType_helper<T>::data;
+template<typename T>
+int _ClassType_helper<T>::lastClassId = 0;
 
 struct ClassesRegistryTable {
     static SQUserPointer slotKey() {
@@ -108,60 +474,329 @@ struct ClassesRegistryTable {
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Per-VM table of ClassData objects indexed by the dense class id (shared by a VM and all of its threads)
+///
+/// \remarks
+/// The table is owned by a userdata in the registry table of the VM. Each thread caches the last VM it looked up, so
+/// that getting the ClassData of a class is an indexed load without stack traffic as long as the same VM (or thread of
+/// a VM) is used; other VMs are looked up in the registry table. Define SQRAT_USE_SHARED_FOREIGN_PTR to keep a pointer
+/// to the table in the shared foreign pointer of the VM instead, which also avoids the lookups when switching between
+/// VMs. Only do so if the host application does not use sq_setsharedforeignptr for its own needs.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct VMClassData {
+    vector<AbstractClassData*> classes;
+    NativeHeap* native;
+
+    explicit VMClassData(HSQUIRRELVM vm) : native(new NativeHeap(vm)) {}
+
+    ~VMClassData() {
+#if !defined(SQRAT_USE_SHARED_FOREIGN_PTR)
+        // Another VM may be created at the same address: drop the lookups cached by every thread
+        DestroyedCount().fetch_add(1, std::memory_order_release);
+#endif
+        for (AbstractClassData* cd : classes)
+            delete cd;
+        // The VM is being closed: destroy what is still queued, objects released from now on are destroyed immediately
+        native->deferDestruction = false;
+        native->DestroyPending(size_t(-1));
+        native->Release();
+    }
+
+    static VMClassData* Get(HSQUIRRELVM vm) {
+#if defined(SQRAT_USE_SHARED_FOREIGN_PTR)
+        return static_cast<VMClassData*>(sq_getsharedforeignptr(vm));
+#else
+        LookupCache& cache = Cache();
+        unsigned destroyed = DestroyedCount().load(std::memory_order_acquire);
+        if (cache.vm == vm && cache.destroyed == destroyed)
+            return cache.data;
+
+        VMClassData** ud = NULL;
+        sq_pushregistrytable(vm);
+        sq_pushuserpointer(vm, ClassesRegistryTable::slotKey());
+        if (SQ_FAILED(sq_rawget_noerr(vm, -2))) {
+            sq_pop(vm, 1);
+            return NULL; // not cached, as the table may be created later
+        }
+        sq_getuserdata(vm, -1, (SQUserPointer*)&ud, NULL);
+        sq_pop(vm, 2);
+        cache.vm = vm;
+        cache.data = *ud;
+        cache.destroyed = destroyed;
+        return *ud;
+#endif
+    }
+
+    static VMClassData* GetOrCreate(HSQUIRRELVM vm) {
+        VMClassData* vd = Get(vm);
+        if (vd)
+            return vd;
+
+        vd = new VMClassData(vm);
+        sq_pushregistrytable(vm);
+        sq_pushuserpointer(vm, ClassesRegistryTable::slotKey());
+        VMClassData** ud = reinterpret_cast<VMClassData**>(sq_newuserdata(vm, sizeof(VMClassData*)));
+        *ud = vd;
+        sq_setreleasehook(vm, -1, &cleanup_hook);
+        SQRAT_VERIFY(SQ_SUCCEEDED(sq_rawset(vm, -3)));
+        sq_pop(vm, 1);
+#if defined(SQRAT_USE_SHARED_FOREIGN_PTR)
+        SQRAT_ASSERT(sq_getsharedforeignptr(vm) == NULL);
+        sq_setsharedforeignptr(vm, vd);
+#endif
+        return vd;
+    }
+
+    // Registers the ClassData of a class in this VM, assigning the class its dense id if it does not have one yet
+    template<class C>
+    void Add(ClassData<C>* cd) {
+        int& id = ClassData<C>::type_id_helper;
+        if (id == 0)
+            id = ++_ClassType_helper<>::lastClassId;
+        if (classes.size() <= size_t(id))
+            classes.resize(id + 1, nullptr);
+        SQRAT_ASSERT(classes[id] == nullptr);
+        classes[id] = cd;
+        cd->heap->Attach(native);
+    }
+
+private:
+
+#if !defined(SQRAT_USE_SHARED_FOREIGN_PTR)
+    // Last VM looked up by a thread, valid as long as no table has been destroyed since
+    struct LookupCache {
+        HSQUIRRELVM vm = NULL;
+        VMClassData* data = NULL;
+        unsigned destroyed = 0;
+    };
+
+    static LookupCache& Cache() {
+        static thread_local LookupCache cache;
+        return cache;
+    }
+
+    // Number of tables destroyed so far (VMs may be closed by other threads than the ones that cached them)
+    static std::atomic<unsigned>& DestroyedCount() {
+        static std::atomic<unsigned> count(0);
+        return count;
+    }
+#endif
+
+    static SQInteger cleanup_hook(SQUserPointer ptr, SQInteger size) {
+        SQRAT_UNUSED(size);
+        VMClassData** ud = reinterpret_cast<VMClassData**>(ptr);
+        delete *ud;
+        return 0;
+    }
+};
+
+#if defined(SQRAT_CLASS_STATS)
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Returns the native memory accounting of every class bound in a VM (requires SQRAT_CLASS_STATS)
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+inline vector<ClassStats> GetClassStats(HSQUIRRELVM vm) {
+    vector<ClassStats> result;
+    if (VMClassData* vd = VMClassData::Get(vm)) {
+        for (AbstractClassData* cd : vd->classes)
+            if (cd)
+                result.push_back(cd->GetStats());
+    }
+    return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Squirrel function returning the native memory accounting of every class bound in the VM, to be bound with SquirrelFunc
+///
+/// \remarks
+/// Returns an array of tables with the slots name, size, live, peak, allocations, frees, liveBytes, peakBytes and nativeBytes.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+inline SQInteger SqClassStats(HSQUIRRELVM vm) {
+    vector<ClassStats> stats = GetClassStats(vm);
+    sq_newarray(vm, 0);
+    for (const ClassStats& cs : stats) {
+        sq_newtable(vm);
+        sq_pushstring(vm, _SC("name"), -1);
+        sq_pushstring(vm, cs.className.c_str(), -1);
+        sq_newslot(vm, -3, SQFalse);
+        const struct { const SQChar* name; size_t value; } fields[] = {
+            { _SC("size"), cs.objectSize },
+            { _SC("live"), cs.live },
+            { _SC("peak"), cs.peak },
+            { _SC("allocations"), cs.allocations },
+            { _SC("frees"), cs.frees },
+            { _SC("liveBytes"), cs.LiveBytes() },
+            { _SC("peakBytes"), cs.PeakBytes() },
+            { _SC("nativeBytes"), cs.nativeBytes },
+        };
+        for (const auto& field : fields) {
+            sq_pushstring(vm, field.name, -1);
+            sq_pushinteger(vm, SQInteger(field.value));
+            sq_newslot(vm, -3, SQFalse);
+        }
+        sq_arrayappend(vm, -2);
+    }
+    return 1;
+}
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Native objects whose destruction was deferred, taken out of a VM with TakeDeferredDestruction
+///
+/// \remarks
+/// The batch doesn't depend on the VM, so it can be destroyed on another thread as long as the destructors of the
+/// objects allow it. Objects still in the batch are destroyed along with it.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class DeferredDestruction {
+public:
+    DeferredDestruction() {}
+    DeferredDestruction(DeferredDestruction&& other) { Swap(other); }
+    DeferredDestruction& operator=(DeferredDestruction&& other) {
+        Run(size_t(-1));
+        Swap(other);
+        return *this;
+    }
+    ~DeferredDestruction() { Run(size_t(-1)); }
+
+    /// Destroys up to budget objects, returns the number destroyed
+    size_t Run(size_t budget) { return heap.DestroyPending(budget); }
+
+    /// Number of objects left to destroy
+    size_t size() const { return heap.pending.size() - heap.head; }
+
+private:
+    friend DeferredDestruction TakeDeferredDestruction(HSQUIRRELVM vm);
+
+    void Swap(DeferredDestruction& other) {
+        heap.pending.swap(other.heap.pending);
+        SQRAT_STD::swap(heap.head, other.heap.head);
+    }
+
+    NativeHeap heap; // only its queue is used
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Makes the release hooks of a VM queue the native objects they release instead of destroying them
+///
+/// \remarks
+/// Applies to objects allocated with the new operator by the allocators (and to the references released by RefCounted),
+/// not to objects stored inside instances (InlineAllocator, PoolAllocator). Queued objects are destroyed by
+/// DestroyDeferred or TakeDeferredDestruction at a time chosen by the host, or when the VM is closed.
+/// The instance accounting (ClassStats) counts objects as freed as soon as they are queued.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+inline void SetDeferredDestruction(HSQUIRRELVM vm, bool defer) {
+    NativeHeap* native = VMClassData::GetOrCreate(vm)->native;
+    native->deferDestruction = defer;
+    if (!defer)
+        native->DestroyPending(size_t(-1));
+}
+
+/// Destroys up to budget native objects queued in a VM, returns the number destroyed
+inline size_t DestroyDeferred(HSQUIRRELVM vm, size_t budget = size_t(-1)) {
+    VMClassData* vd = VMClassData::Get(vm);
+    return vd ? vd->native->DestroyPending(budget) : 0;
+}
+
+/// Returns the number of native objects waiting for destruction in a VM
+inline size_t DeferredDestructionCount(HSQUIRRELVM vm) {
+    VMClassData* vd = VMClassData::Get(vm);
+    return vd ? vd->native->pending.size() - vd->native->head : 0;
+}
+
+#if defined(SQRAT_CLASS_STATS)
+/// Returns the native footprint (see NativeFootprint) of the objects kept alive by the instances of a VM (requires
+/// SQRAT_CLASS_STATS)
+inline size_t GetNativeBytes(HSQUIRRELVM vm) {
+    VMClassData* vd = VMClassData::Get(vm);
+    return vd ? vd->native->nativeBytes : 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Sets a function called when the native bytes of a VM (see GetNativeBytes) reach a threshold (requires SQRAT_CLASS_STATS)
+///
+/// \param vm        VM to watch
+/// \param threshold Number of native bytes at which the callback is called
+/// \param callback  Function called with the VM the classes were first bound with, the native bytes and userData
+///                   (NULL to remove the callback)
+/// \param userData  Pointer passed to the callback
+///
+/// \remarks
+/// The callback is called once when an allocation reaches the threshold, and again only after the native bytes have dropped
+/// below it.
+/// It is called while an instance is being set up, so it should only trigger sq_collectgarbage when that is safe for the
+/// host, or record the request for the next safe point.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+inline void SetNativeMemoryThreshold(HSQUIRRELVM vm, size_t threshold,
+                                     void (*callback)(HSQUIRRELVM vm, size_t nativeBytes, void* userData), void* userData = NULL) {
+    NativeHeap* native = VMClassData::GetOrCreate(vm)->native;
+    native->threshold = threshold;
+    native->thresholdCallback = callback;
+    native->thresholdUserData = userData;
+    native->thresholdReached = false; // called on the next allocation if the threshold is already exceeded
+}
+#endif
+
+/// Takes all the native objects queued in a VM, to destroy them later or on another thread
+inline DeferredDestruction TakeDeferredDestruction(HSQUIRRELVM vm) {
+    DeferredDestruction batch;
+    if (VMClassData* vd = VMClassData::Get(vm)) {
+        NativeHeap* native = vd->native;
+        batch.heap.pending.assign(native->pending.begin() + native->head, native->pending.end());
+        native->pending.clear();
+        native->head = 0;
+    }
+    return batch;
+}
+
 // Internal helper class for managing classes
 template<class C>
 class ClassType {
 public:
 
     static inline ClassData<C>* getClassData(HSQUIRRELVM vm) {
-        sq_pushregistrytable(vm);
-        sq_pushuserpointer(vm, ClassesRegistryTable::slotKey());
-        SQRESULT r = sq_rawget(vm, -2);
-        SQRAT_ASSERT(SQ_SUCCEEDED(r)); // fails if getClassData is called when the data does not exist for the given VM yet (bind the class)
-        sq_pushuserpointer(vm, ClassData<C>::type_id());
-
-        r = sq_rawget(vm, -2);
-        SQRAT_ASSERT(SQ_SUCCEEDED(r)); // fails if getClassData is called when the data does not exist for the given VM yet (bind the class)
-        ClassData<C>** ud;
-        sq_getuserdata(vm, -1, (SQUserPointer*)&ud, NULL);
-        sq_pop(vm, 3);
-        return *ud;
+        VMClassData* vd = VMClassData::Get(vm);
+        int id = ClassData<C>::type_id_helper;
+        SQRAT_ASSERT(vd && id != 0 && size_t(id) < vd->classes.size() && vd->classes[id] != nullptr); // fails if getClassData is called when the data does not exist for the given VM yet (bind the class)
+        return static_cast<ClassData<C>*>(vd->classes[id]);
     }
 
     static weak_ptr<AbstractStaticClassData>& getStaticClassData() {
         return _ClassType_helper<>::_getStaticClassData(ClassData<C>::type_id());
     }
 
+    // Lock-free access to the static class data (nullptr if the class is not bound in any VM)
+    static inline AbstractStaticClassData* getStaticClassDataPtr() {
+        return ClassData<C>::static_data;
+    }
+
+    // Takes ownership of newly created static class data for C and publishes it to getStaticClassDataPtr()
+    static void setStaticClassData(ClassData<C>* cd, AbstractStaticClassData* staticData) {
+        cd->staticData.reset(staticData, &releaseStaticClassData);
+        ClassData<C>::static_data = staticData;
+        getStaticClassData() = cd->staticData;
+    }
+
     static inline bool hasClassData(HSQUIRRELVM vm) {
-        if (!getStaticClassData().expired()) {
-            sq_pushregistrytable(vm);
-            sq_pushuserpointer(vm, ClassesRegistryTable::slotKey());
-            if (SQ_SUCCEEDED(sq_rawget(vm, -2))) {
-                sq_pushuserpointer(vm, ClassData<C>::type_id());
-                if (SQ_SUCCEEDED(sq_rawget(vm, -2))) {
-                    sq_pop(vm, 3);
-                    return true;
-                }
-                sq_pop(vm, 1);
-            }
-            sq_pop(vm, 1);
-        }
-        return false;
+        int id = ClassData<C>::type_id_helper;
+        if (id == 0)
+            return false;
+        VMClassData* vd = VMClassData::Get(vm);
+        return vd && size_t(id) < vd->classes.size() && vd->classes[id] != nullptr;
     }
 
     static inline AbstractStaticClassData*& BaseClass() {
-        SQRAT_ASSERT(getStaticClassData().expired() == false); // fails because called before a Sqrat::Class for this type exists
-        return getStaticClassData().lock()->baseClass;
+        SQRAT_ASSERT(getStaticClassDataPtr() != nullptr); // fails because called before a Sqrat::Class for this type exists
+        return getStaticClassDataPtr()->baseClass;
     }
 
     static inline string& ClassName() {
-        SQRAT_ASSERT(getStaticClassData().expired() == false); // fails because called before a Sqrat::Class for this type exists
-        return getStaticClassData().lock()->className;
+        SQRAT_ASSERT(getStaticClassDataPtr() != nullptr); // fails because called before a Sqrat::Class for this type exists
+        return getStaticClassDataPtr()->className;
     }
 
     static inline COPYFUNC& CopyFunc() {
-        SQRAT_ASSERT(getStaticClassData().expired() == false); // fails because called before a Sqrat::Class for this type exists
-        return getStaticClassData().lock()->copyFunc;
+        SQRAT_ASSERT(getStaticClassDataPtr() != nullptr); // fails because called before a Sqrat::Class for this type exists
+        return getStaticClassDataPtr()->copyFunc;
     }
 
     static bool IsObjectOfClass(const HSQOBJECT *obj)
@@ -171,17 +806,14 @@ public:
             return false;
         if (!actualType)
             return false;
-        AbstractStaticClassData* thisClass = getStaticClassData().lock().get();
-        for (AbstractStaticClassData *cls = actualType; cls; cls = cls->baseClass)
-            if (cls == thisClass)
-                return true;
-        return false;
+        return actualType->IsSubclassOf(getStaticClassDataPtr());
     }
 
     static SQInteger DeleteInstance(SQUserPointer ptr, SQInteger size) {
         SQRAT_UNUSED(size);
         InstancePtrAndMap<C> *instance = reinterpret_cast<InstancePtrAndMap<C>*>(ptr);
-        instance->second->erase(instance->first);
+        if (instance->second)
+            instance->second->erase(instance->first);
         delete instance;
         return 0;
     }
@@ -194,12 +826,70 @@ public:
 
         ClassData<C>* cd = getClassData(vm);
 
-        auto it = cd->instances->find(ptr);
-        if (it != cd->instances->end()) {
-            sq_pushobject(vm, it->second);
+        if (cd->instances) {
+            auto it = cd->instances->find(ptr);
+            if (it != cd->instances->end()) {
+                sq_pushobject(vm, it->second);
+                return true;
+            }
+        }
+
+        sq_pushobject(vm, cd->classObj);
+        if (SQ_FAILED(sq_createinstance(vm, -1))) {
+          SQRAT_ASSERT(!"Failed to create class instance");
+          sq_pop(vm, 1);
+          return false;
+        }
+
+        sq_remove(vm, -2);
+        if (cd->pushAcquire) {
+            cd->pushAcquire(ptr);
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_setinstanceup(vm, -1, new OwnedInstance<C>(ptr, cd))));
+            sq_setreleasehook(vm, -1, cd->pushRelease);
+        }
+        else {
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_setinstanceup(vm, -1, new InstancePtrAndMap<C>(ptr, cd->instances))));
+            sq_setreleasehook(vm, -1, &DeleteInstance);
+        }
+        if (cd->instances)
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, -1, &((*cd->instances)[ptr]))));
+        return true;
+    }
+
+    template<class Owner>
+    static SQInteger DeleteSharedInstance(SQUserPointer ptr, SQInteger size) {
+        SQRAT_UNUSED(size);
+        SharedInstance<C, Owner> *instance = reinterpret_cast<SharedInstance<C, Owner>*>(ptr);
+        if (instance->second)
+            instance->second->erase(instance->first);
+        delete instance;
+        return 0;
+    }
+
+    // Pushes an instance sharing the ownership of ptr (a std or eastl shared_ptr to C), reusing the existing instance of the object if it
+    // keeps the object alive too. Owner is shared_ptr<void> of the same kind as ptr.
+    template<class Owner, class SharedPtr>
+    static bool PushSharedInstance(HSQUIRRELVM vm, const SharedPtr& ptr) {
+        C* obj = const_cast<C*>(ptr.get());
+        if (!obj) {
+            sq_pushnull(vm);
             return true;
         }
 
+        ClassData<C>* cd = getClassData(vm);
+
+        if (cd->instances) {
+            auto it = cd->instances->find(obj);
+            if (it != cd->instances->end()) {
+                sq_pushobject(vm, it->second);
+                // An instance pushed from a plain pointer doesn't own the object and could outlive it
+                SQRELEASEHOOK hook = sq_getreleasehook(vm, -1);
+                if (hook == &DeleteSharedInstance<Owner> || (cd->pushRelease && hook == cd->pushRelease))
+                    return true;
+                sq_pop(vm, 1);
+            }
+        }
+
         sq_pushobject(vm, cd->classObj);
         if (SQ_FAILED(sq_createinstance(vm, -1))) {
           SQRAT_ASSERT(!"Failed to create class instance");
@@ -208,9 +898,57 @@ public:
         }
 
         sq_remove(vm, -2);
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_setinstanceup(vm, -1, new InstancePtrAndMap<C>(ptr, cd->instances))));
-        sq_setreleasehook(vm, -1, &DeleteInstance);
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, -1, &((*cd->instances)[ptr]))));
+        SQRAT_VERIFY(SQ_SUCCEEDED(sq_setinstanceup(vm, -1, new SharedInstance<C, Owner>(obj, cd, Owner(ptr, obj)))));
+        sq_setreleasehook(vm, -1, &DeleteSharedInstance<Owner>);
+        if (cd->instances)
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, -1, &((*cd->instances)[obj]))));
+        return true;
+    }
+
+    // Returns the shared_ptr<void> (of the Owner kind) owning the object of the instance at idx, or NULL if the instance doesn't share ownership
+    template<class Owner>
+    static const Owner* GetSharedOwner(HSQUIRRELVM vm, SQInteger idx) {
+        SQUserPointer up = NULL;
+        AbstractStaticClassData* actualType = NULL;
+        if (SQ_FAILED(sq_getinstanceup(vm, idx, &up, NULL)) || !up)
+            return NULL;
+        if (SQ_FAILED(sq_gettypetag(vm, idx, (SQUserPointer*)&actualType)) || !actualType)
+            return NULL;
+        return actualType->GetSharedOwner(up, sq_getreleasehook(vm, idx), static_cast<const Owner*>(NULL));
+    }
+
+    template<class Owner>
+    static const Owner* SharedOwnerOf(SQUserPointer up, SQRELEASEHOOK hook) {
+        if (hook != &DeleteSharedInstance<Owner>)
+            return NULL;
+        return &static_cast<SharedInstance<C, Owner>*>(up)->owner;
+    }
+
+#if defined(SQRAT_CLASS_STATS)
+    // Returns the native memory accounting of the class in the VM
+    static ClassStats GetStats(HSQUIRRELVM vm) {
+        return getClassData(vm)->GetStats();
+    }
+#endif
+
+    // Pushes a new instance holding the object moved out of value, or a copy of it if the allocator doesn't support moving.
+    // Pushes nothing and returns false if the allocator fails to set up the instance (e.g. the class can't be copied).
+    static bool PushInstanceMove(HSQUIRRELVM vm, C& value) {
+        MOVEFUNC moveFunc = getStaticClassDataPtr()->moveFunc;
+        if (!moveFunc)
+            return PushInstanceCopy(vm, value);
+        sq_pushobject(vm, getClassData(vm)->classObj);
+        if (SQ_FAILED(sq_createinstance(vm, -1))) {
+            SQRAT_ASSERT(!"Failed to create class instance");
+            sq_pop(vm, 1);
+            return false;
+        }
+        sq_remove(vm, -2);
+        if (SQ_FAILED(moveFunc(vm, -1, &value))) {
+            SQRAT_ASSERT(!"Failed to move into class instance"); // the class is neither movable nor copyable
+            sq_pop(vm, 1);
+            return false;
+        }
         return true;
     }
 
@@ -233,14 +971,14 @@ public:
                 return NULL;
             }
 
-            classType = getStaticClassData().lock().get();
+            classType = getStaticClassDataPtr();
 
             if (SQ_FAILED(sq_getinstanceup(vm, idx, (SQUserPointer*)&instance, classType))) {
                 SQRAT_ASSERTF(0, FormatTypeError(vm, idx, ClassName().c_str()).c_str());
                 return NULL;
             }
 
-            if (instance == NULL) {
+            if (instance == NULL || !sq_getreleasehook(vm, idx)) { // see GetInstanceRecord
                 SQRAT_ASSERTF(0, _SC("got unconstructed native class (call base.constructor in the constructor of Squirrel classes that extend native classes)"));
                 return NULL;
             }
@@ -252,7 +990,7 @@ public:
         }
         AbstractStaticClassData* actualType;
         sq_gettypetag(vm, idx, (SQUserPointer*)&actualType);
-        if (actualType == NULL) {
+        if (actualType == NULL) { // only for Squirrel classes which overrode _inherited, others get the typetag of the nearest native class
             SQInteger top = sq_gettop(vm);
             sq_getclass(vm, idx);
             while (actualType == NULL) {
@@ -261,10 +999,7 @@ public:
             }
             sq_settop(vm, top);
         }
-        if (classType != actualType) {
-            return static_cast<C*>(actualType->Cast(instance->first, classType));
-        }
-        return static_cast<C*>(instance->first);
+        return static_cast<C*>(actualType->Upcast(instance->first, classType));
     }
 
 
@@ -274,16 +1009,74 @@ public:
             return true;
         if (type != OT_INSTANCE)
             return false;
-        AbstractStaticClassData* classType = getStaticClassData().lock().get();
+        AbstractStaticClassData* classType = getStaticClassDataPtr();
         AbstractStaticClassData* actualType = nullptr;
-        if (SQ_FAILED(sq_gettypetag(vm, idx, (SQUserPointer*)&actualType)))
+        if (SQ_FAILED(sq_gettypetag(vm, idx, (SQUserPointer*)&actualType)) || !actualType)
             return false;
-        for (; actualType; actualType=actualType->baseClass) {
-            if (actualType == classType) {
-                return true;
+        return actualType->IsSubclassOf(classType) && HasNativeObject(vm, idx);
+    }
+
+    // Gets the object of the instance obj at idx, already fetched from the stack, if IsClassInstance accepts it (NULL
+    // otherwise). Checking and getting take a single pass over the type tag and the instance record.
+    static C* GetClassInstance(HSQUIRRELVM vm, SQInteger idx, const HSQOBJECT& obj) {
+        if (!sq_isinstance(obj))
+            return NULL;
+        AbstractStaticClassData* classType = getStaticClassDataPtr();
+        AbstractStaticClassData* actualType = AbstractStaticClassData::FromObject(&obj);
+        if (!actualType || !actualType->IsSubclassOf(classType))
+            return NULL;
+        InstancePtrAndMap<C>* instance = GetInstanceRecord(vm, idx);
+        if (instance == NULL)
+            return NULL;
+        return static_cast<C*>(actualType->Upcast(instance->first, classType));
+    }
+
+    // Returns true if the value at idx is an instance of this class whose native object was never created, which is
+    // the case for Squirrel classes extending native classes that do not call base.constructor in their constructor
+    static bool IsUnconstructedInstance(HSQUIRRELVM vm, SQInteger idx) {
+        if (sq_gettype(vm, idx) != OT_INSTANCE)
+            return false;
+        AbstractStaticClassData* actualType = nullptr;
+        if (SQ_FAILED(sq_gettypetag(vm, idx, (SQUserPointer*)&actualType)) || !actualType)
+            return false;
+        return actualType->IsSubclassOf(getStaticClassDataPtr()) && !HasNativeObject(vm, idx);
+    }
+
+    // Gets the object of the instance obj at idx, already accepted by IsClassInstance, without checking its type again
+    static C* GetCheckedInstance(HSQUIRRELVM vm, SQInteger idx, const HSQOBJECT& obj) {
+        InstancePtrAndMap<C> * instance = GetInstanceRecord(vm, idx);
+        if (instance == NULL) {
+            SQRAT_ASSERTF(0, _SC("got unconstructed native class (call base.constructor in the constructor of Squirrel classes that extend native classes)"));
+            return NULL;
+        }
+        AbstractStaticClassData* actualType = NULL;
+        sq_getobjtypetag(&obj, (SQUserPointer*)&actualType);
+        if (actualType == NULL) { // only for Squirrel classes which overrode _inherited, see GetInstance
+            SQInteger top = sq_gettop(vm);
+            sq_getclass(vm, idx);
+            while (actualType == NULL) {
+                sq_getbase(vm, -1);
+                sq_gettypetag(vm, -1, (SQUserPointer*)&actualType);
             }
+            sq_settop(vm, top);
         }
-        return false;
+        return static_cast<C*>(actualType->Upcast(instance->first, getStaticClassDataPtr()));
+    }
+
+    // Returns the instance record of the value at idx (without checking its class), or NULL if it has no native object.
+    // Instances of Squirrel classes whose constructor did not call base.constructor have a NULL userpointer, or one
+    // pointing to uninitialized userdata if the class has a userdata size (see InlineAllocator). Every record is set
+    // together with its release hook, so an instance without release hook has no record.
+    static InstancePtrAndMap<C>* GetInstanceRecord(HSQUIRRELVM vm, SQInteger idx) {
+        SQUserPointer up = NULL;
+        if (SQ_FAILED(sq_getinstanceup(vm, idx, &up, NULL)) || up == NULL || !sq_getreleasehook(vm, idx))
+            return NULL;
+        return static_cast<InstancePtrAndMap<C>*>(up);
+    }
+
+    // Returns true if the value at idx is an instance with a native object (without checking its class)
+    static bool HasNativeObject(HSQUIRRELVM vm, SQInteger idx) {
+        return GetInstanceRecord(vm, idx) != NULL;
     }
 
     static SQInteger ToString(HSQUIRRELVM vm) {
@@ -295,12 +1088,31 @@ public:
         sq_pushstring(vm, str.c_str(), l);
         return 1;
     }
+
+private:
+
+    static void releaseStaticClassData(AbstractStaticClassData* staticData) {
+        if (ClassData<C>::static_data == staticData)
+            ClassData<C>::static_data = nullptr;
+        ++AbstractStaticClassData::HierarchyVersion();
+        delete staticData;
+    }
 };
 
 template<class C, class B> bool StaticClassData<C, B>::PushInstance(HSQUIRRELVM vm, void *ptr) {
     return ClassType<C>::PushInstance(vm, reinterpret_cast<C*>(ptr));
 }
 
+template<class C, class B> const std::shared_ptr<void>* StaticClassData<C, B>::GetSharedOwner(SQUserPointer up, SQRELEASEHOOK hook, const std::shared_ptr<void>*) {
+    return ClassType<C>::template SharedOwnerOf<std::shared_ptr<void>>(up, hook);
+}
+
+#if defined(SQRAT_HAS_EASTL)
+template<class C, class B> const eastl::shared_ptr<void>* StaticClassData<C, B>::GetSharedOwner(SQUserPointer up, SQRELEASEHOOK hook, const eastl::shared_ptr<void>*) {
+    return ClassType<C>::template SharedOwnerOf<eastl::shared_ptr<void>>(up, hook);
+}
+#endif
+
 
 }
 
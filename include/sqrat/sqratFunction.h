@@ -230,7 +230,7 @@ public:
                           vargs::TailElem_t<ArgsAndRet...>>::type R;
 
       R& ret = vargs::tail(SQRAT_STD::forward<ArgsAndRet>(args_and_ret)...);
-      ret = Var<R>(savedVm, -1).value;
+      ret = Var<R>(savedVm, -1).value; // copied before the result is popped, as Var<R> may refer to it
       sq_settop(savedVm, top);
       return true;
     }
@@ -42,48 +42,157 @@ template <class Callable, class... Args>
 class SqThunkGen<Callable, void(Args...)>
 {
 public:
-  template <SQInteger startIdx, bool overloaded>
+  template <SQInteger startIdx, bool overloaded, ArgCheck check = ArgCheck::All>
   static SQInteger Func(HSQUIRRELVM vm)
   {
-    if (!vargs::check_var_types<Args...>(vm, startIdx))
+    vargs::VarObjects<sizeof...(Args)> objs;
+    if (!vargs::get_var_objects<check, Args...>(vm, startIdx, objs))
       return SQ_ERROR;
 
-    Callable *method;
-    sq_getuserdata(vm, -1, (SQUserPointer *)&method, NULL);
-    auto vars = vargs::make_vars<Args...>(vm, startIdx);
+    Callable *method = SqGetCallable<Callable, overloaded>(vm);
+    auto vars = vargs::make_vars<Args...>(vm, startIdx, objs);
     vargs::apply(*method, vars);
     return 0;
   }
+
+  // Same as Func for a function known at compile time, bound without a free variable
+  template <Callable func, SQInteger startIdx, ArgCheck check = ArgCheck::All>
+  static SQInteger FuncDirect(HSQUIRRELVM vm)
+  {
+    vargs::VarObjects<sizeof...(Args)> objs;
+    if (!vargs::get_var_objects<check, Args...>(vm, startIdx, objs))
+      return SQ_ERROR;
+
+    auto vars = vargs::make_vars<Args...>(vm, startIdx, objs);
+    vargs::apply_direct<func>(vars);
+    return 0;
+  }
 };
 
 template <class Callable, class R, class... Args>
 class SqThunkGen<Callable, R(Args...)>
 {
 public:
-  template <SQInteger startIdx, bool overloaded>
+  template <SQInteger startIdx, bool overloaded, ArgCheck check = ArgCheck::All>
   static SQInteger Func(HSQUIRRELVM vm)
   {
-    if (!vargs::check_var_types<Args...>(vm, startIdx))
+    vargs::VarObjects<sizeof...(Args)> objs;
+    if (!vargs::get_var_objects<check, Args...>(vm, startIdx, objs))
+      return SQ_ERROR;
+
+    Callable *method = SqGetCallable<Callable, overloaded>(vm);
+    auto vars = vargs::make_vars<Args...>(vm, startIdx, objs);
+    PushVarResult<R>(vm, vargs::apply(*method, vars));
+    return 1;
+  }
+
+  // Same as Func for a function known at compile time, bound without a free variable
+  template <Callable func, SQInteger startIdx, ArgCheck check = ArgCheck::All>
+  static SQInteger FuncDirect(HSQUIRRELVM vm)
+  {
+    vargs::VarObjects<sizeof...(Args)> objs;
+    if (!vargs::get_var_objects<check, Args...>(vm, startIdx, objs))
+      return SQ_ERROR;
+
+    auto vars = vargs::make_vars<Args...>(vm, startIdx, objs);
+    PushVarResult<R>(vm, vargs::apply_direct<func>(vars));
+    return 1;
+  }
+
+  // Same as Func, but an instance of the result class may be passed after the arguments:
+  // the result is then assigned to its object and that instance is returned instead of a new one
+  template <SQInteger startIdx>
+  static SQInteger FuncDest(HSQUIRRELVM vm)
+  {
+    typedef SQRAT_STD::remove_cv_t<SQRAT_STD::remove_reference_t<R>> Dest;
+    static_assert(SQRAT_STD::is_class<Dest>::value, "FuncDest requires a function returning a class");
+
+    const SQInteger destIdx = startIdx + sizeof...(Args);
+    const SQInteger top = sq_gettop(vm);
+    if (top == destIdx)
+      return Func<startIdx, false>(vm);
+    if (top != destIdx + 1)
+      return sq_throwerror(vm, _SC("wrong number of parameters"));
+
+    vargs::VarObjects<sizeof...(Args)> objs;
+    VarObject destArg;
+    if (!vargs::get_var_objects<Args...>(vm, startIdx, objs) || !vargs::get_var_object<Dest&>(vm, destIdx, destArg))
       return SQ_ERROR;
 
     Callable *method;
     sq_getuserdata(vm, -1, (SQUserPointer *)&method, NULL);
-    auto vars = vargs::make_vars<Args...>(vm, startIdx);
-    PushVar(vm, vargs::apply(*method, vars));
+    auto vars = vargs::make_vars<Args...>(vm, startIdx, objs);
+    Var<Dest&>(vm, destIdx, destArg).value = vargs::apply(*method, vars);
+    sq_push(vm, destIdx);
     return 1;
   }
 };
 
+// Thunk of functions taking all the arguments of the call as an ArgSpan
+template<class Callable, class Sig = get_callable_function_t<Callable>>
+class SqVarargThunkGen;
+
+template <class Callable, class R>
+class SqVarargThunkGen<Callable, R(ArgSpan)>
+{
+public:
+  template <SQInteger startIdx>
+  static SQInteger Func(HSQUIRRELVM vm)
+  {
+    Callable *method = SqGetCallable<Callable, false>(vm);
+    ArgSpan args(vm, startIdx, sq_gettop(vm) - startIdx); // the callable is on top of the arguments
+    if constexpr (SQRAT_STD::is_void<R>::value) {
+      (*method)(args);
+      return 0;
+    }
+    else {
+      PushVarResult<R>(vm, (*method)(args));
+      return 1;
+    }
+  }
+};
+
 template<class Callable>
+SQFUNCTION SqGlobalVarargThunk()
+{
+  return &SqVarargThunkGen<Callable>::template Func<2>;
+}
+
+// Thunks bound with the typemask of their signature (see SqGetTypeMask) can be made with ArgCheck::Unmasked
+template<class Callable, ArgCheck check>
 SQFUNCTION SqGlobalThunk()
 {
-  return &SqThunkGen<Callable>::template Func<2, false>;
+  return &SqThunkGen<Callable>::template Func<2, false, check>;
 }
 
-template<class Callable>
+template<class Callable, ArgCheck check = ArgCheck::All>
 SQFUNCTION SqMemberGlobalThunk()
 {
-  return &SqThunkGen<Callable>::template Func<1, false>;
+  return &SqThunkGen<Callable>::template Func<1, false, check>;
+}
+
+template<auto func, ArgCheck check = ArgCheck::All>
+SQFUNCTION SqGlobalThunkDirect()
+{
+  return &SqThunkGen<decltype(func)>::template FuncDirect<func, 2, check>;
+}
+
+template<auto func, ArgCheck check = ArgCheck::All>
+SQFUNCTION SqMemberGlobalThunkDirect()
+{
+  return &SqThunkGen<decltype(func)>::template FuncDirect<func, 1, check>;
+}
+
+template<class Callable>
+SQFUNCTION SqGlobalThunkDest()
+{
+  return &SqThunkGen<Callable>::template FuncDest<2>;
+}
+
+template<class Callable>
+SQFUNCTION SqMemberGlobalThunkDest()
+{
+  return &SqThunkGen<Callable>::template FuncDest<1>;
 }
 
 }
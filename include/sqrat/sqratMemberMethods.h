@@ -36,27 +36,97 @@
 namespace Sqrat {
 
 
+// Instance of a member function call, taken without validating its class for trusted callers. Returns NULL after
+// raising an error if there is no object to call the function on (e.g. an unconstructed instance).
+template<class C, ArgCheck check>
+C* SqGetThis(HSQUIRRELVM vm)
+{
+  C* ptr;
+  if constexpr (arg_check_enabled<check>)
+    ptr = Var<C *>(vm, 1).value;
+  else {
+    HSQOBJECT obj;
+    sq_getstackobj(vm, 1, &obj);
+    ptr = ClassType<C>::GetCheckedInstance(vm, 1, obj);
+  }
+  if (!ptr) {
+    if (ClassType<C>::IsUnconstructedInstance(vm, 1))
+      sq_throwerror(vm, _SC("got unconstructed native class (call base.constructor in the constructor of Squirrel classes that extend native classes)"));
+    else
+      sq_throwerror(vm, FormatTypeError(vm, 1, ClassType<C>::ClassName().c_str()).c_str());
+  }
+  return ptr;
+}
+
 template<class C, class MemberFunc, class MemberFuncSig = member_function_signature_t<MemberFunc>>
 struct SqMemberThunkGen;
 
 template<class C, class MemberFunc, class R, class... A>
 struct SqMemberThunkGen<C, MemberFunc, R(A...)>
 {
-  template <bool overloaded>
+  template <bool overloaded, ArgCheck check = ArgCheck::All>
   static SQInteger Func(HSQUIRRELVM vm)
   {
-    if (!SQRAT_CONST_CONDITION(overloaded) && sq_gettop(vm) != 2 + sizeof...(A))
+    if (!SQRAT_CONST_CONDITION(overloaded) && arg_check_enabled<check> && sq_gettop(vm) != 2 + sizeof...(A))
+      return sq_throwerror(vm, _SC("wrong number of parameters"));
+
+    vargs::VarObjects<sizeof...(A)> objs;
+    if (!vargs::get_var_objects<check, A...>(vm, 2, objs))
+      return SQ_ERROR;
+
+    MemberFunc *methodPtr = SqGetCallable<MemberFunc, overloaded>(vm);
+    C *ptr = SqGetThis<C, check>(vm);
+    if (!ptr)
+      return SQ_ERROR;
+    auto vars = vargs::make_vars<A...>(vm, 2, objs);
+    PushVarResult<R>(vm, vargs::apply_member(ptr, *methodPtr, vars));
+    return 1;
+  }
+
+  // Same as Func for a member function known at compile time, bound without a free variable (sq_setparamscheck checks the arity)
+  template <MemberFunc method, ArgCheck check = ArgCheck::All>
+  static SQInteger FuncDirect(HSQUIRRELVM vm)
+  {
+    vargs::VarObjects<sizeof...(A)> objs;
+    if (!vargs::get_var_objects<check, A...>(vm, 2, objs))
+      return SQ_ERROR;
+
+    C *ptr = SqGetThis<C, check>(vm);
+    if (!ptr)
+      return SQ_ERROR;
+    auto vars = vargs::make_vars<A...>(vm, 2, objs);
+    PushVarResult<R>(vm, vargs::apply_member_direct<method>(ptr, vars));
+    return 1;
+  }
+
+  // Same as Func, but an instance of the result class may be passed after the arguments:
+  // the result is then assigned to its object and that instance is returned instead of a new one
+  static SQInteger FuncDest(HSQUIRRELVM vm)
+  {
+    typedef SQRAT_STD::remove_cv_t<SQRAT_STD::remove_reference_t<R>> Dest;
+    static_assert(SQRAT_STD::is_class<Dest>::value, "FuncDest requires a function returning a class");
+
+    const SQInteger destIdx = 2 + sizeof...(A);
+    const SQInteger top = sq_gettop(vm);
+    if (top == destIdx)
+      return Func<false>(vm);
+    if (top != destIdx + 1)
       return sq_throwerror(vm, _SC("wrong number of parameters"));
 
-    if (!vargs::check_var_types<A...>(vm, 2))
+    vargs::VarObjects<sizeof...(A)> objs;
+    VarObject destArg;
+    if (!vargs::get_var_objects<A...>(vm, 2, objs) || !vargs::get_var_object<Dest&>(vm, destIdx, destArg))
       return SQ_ERROR;
 
     MemberFunc *methodPtr;
     sq_getuserdata(vm, -1, (SQUserPointer *)&methodPtr, NULL);
 
-    C *ptr = Var<C *>(vm, 1).value;
-    auto vars = vargs::make_vars<A...>(vm, 2);
-    PushVar(vm, vargs::apply_member(ptr, *methodPtr, vars));
+    C *ptr = SqGetThis<C, ArgCheck::All>(vm);
+    if (!ptr)
+      return SQ_ERROR;
+    auto vars = vargs::make_vars<A...>(vm, 2, objs);
+    Var<Dest&>(vm, destIdx, destArg).value = vargs::apply_member(ptr, *methodPtr, vars);
+    sq_push(vm, destIdx);
     return 1;
   }
 };
@@ -64,33 +134,93 @@ struct SqMemberThunkGen<C, MemberFunc, R(A...)>
 template<class C, class MemberFunc, class... A>
 struct SqMemberThunkGen<C, MemberFunc, void(A...)>
 {
-  template <bool overloaded>
+  template <bool overloaded, ArgCheck check = ArgCheck::All>
   static SQInteger Func(HSQUIRRELVM vm)
   {
-    if (!SQRAT_CONST_CONDITION(overloaded) && sq_gettop(vm) != 2 + sizeof...(A))
+    if (!SQRAT_CONST_CONDITION(overloaded) && arg_check_enabled<check> && sq_gettop(vm) != 2 + sizeof...(A))
       return sq_throwerror(vm, _SC("wrong number of parameters"));
 
-    if (!vargs::check_var_types<A...>(vm, 2))
+    vargs::VarObjects<sizeof...(A)> objs;
+    if (!vargs::get_var_objects<check, A...>(vm, 2, objs))
       return SQ_ERROR;
 
-    MemberFunc *methodPtr;
-    sq_getuserdata(vm, -1, (SQUserPointer *)&methodPtr, NULL);
-
-    C *ptr = Var<C *>(vm, 1).value;
-    auto vars = vargs::make_vars<A...>(vm, 2);
+    MemberFunc *methodPtr = SqGetCallable<MemberFunc, overloaded>(vm);
+    C *ptr = SqGetThis<C, check>(vm);
+    if (!ptr)
+      return SQ_ERROR;
+    auto vars = vargs::make_vars<A...>(vm, 2, objs);
     vargs::apply_member(ptr, *methodPtr, vars);
     return 0;
   }
+
+  template <MemberFunc method, ArgCheck check = ArgCheck::All>
+  static SQInteger FuncDirect(HSQUIRRELVM vm)
+  {
+    vargs::VarObjects<sizeof...(A)> objs;
+    if (!vargs::get_var_objects<check, A...>(vm, 2, objs))
+      return SQ_ERROR;
+
+    C *ptr = SqGetThis<C, check>(vm);
+    if (!ptr)
+      return SQ_ERROR;
+    auto vars = vargs::make_vars<A...>(vm, 2, objs);
+    vargs::apply_member_direct<method>(ptr, vars);
+    return 0;
+  }
 };
 
 //
 // Member Function Resolvers
 //
 
+// Thunk of member functions taking all the arguments of the call as an ArgSpan
+template<class C, class MemberFunc, class MemberFuncSig = member_function_signature_t<MemberFunc>>
+struct SqMemberVarargThunkGen;
+
+template<class C, class MemberFunc, class R>
+struct SqMemberVarargThunkGen<C, MemberFunc, R(ArgSpan)>
+{
+  static SQInteger Func(HSQUIRRELVM vm)
+  {
+    MemberFunc *methodPtr = SqGetCallable<MemberFunc, false>(vm);
+    C *ptr = SqGetThis<C, ArgCheck::All>(vm);
+    if (!ptr)
+      return SQ_ERROR;
+
+    ArgSpan args(vm, 2, sq_gettop(vm) - 2); // the callable is on top of the arguments
+    if constexpr (SQRAT_STD::is_void<R>::value) {
+      (ptr->*(*methodPtr))(args);
+      return 0;
+    }
+    else {
+      PushVarResult<R>(vm, (ptr->*(*methodPtr))(args));
+      return 1;
+    }
+  }
+};
+
 template<class C, class MemberFunc>
+SQFUNCTION SqMemberVarargFunc()
+{
+  return &SqMemberVarargThunkGen<C, MemberFunc>::Func;
+}
+
+template<class C, class MemberFunc, ArgCheck check = ArgCheck::All>
 SQFUNCTION SqMemberFunc()
 {
-  return &SqMemberThunkGen<C, MemberFunc>::template Func<false>;
+  return &SqMemberThunkGen<C, MemberFunc>::template Func<false, check>;
+}
+
+template<class C, class MemberFunc>
+SQFUNCTION SqMemberFuncDest()
+{
+  return &SqMemberThunkGen<C, MemberFunc>::FuncDest;
+}
+
+template<class C, auto method, ArgCheck check = ArgCheck::All>
+SQFUNCTION SqMemberFuncDirect()
+{
+  return &SqMemberThunkGen<C, decltype(method)>::template FuncDirect<method, check>;
 }
 
 
@@ -250,9 +250,22 @@ public:
     T Cast() const {
         static_assert(VarControlsValueLifeTime<T>::value == 0,
                       "direct cast to T failed due to value is bound to Var<T>. use GetVar() instead");
-        return GetVar<T>().value;
+        sq_pushobject(vm, GetObject());
+        T ret = Var<T>(vm, -1).value;
+        sq_pop(vm, 1);
+        return ret;
     }
 
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Gets the object as a Var of a certain C++ type
+    /// \tparam T Type to get
+    /// \return A Var holding the value of the Object with the given type
+    ///
+    /// \remarks
+    /// The value of a Var of a bound class refers to the native object of the instance instead of a copy, so it must not be
+    /// used after this Object (or any other reference keeping the instance alive) is released. Use Cast to get a copy.
+    ///
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     template<class T>
     Var<T>  GetVar() const
     {
@@ -386,7 +399,8 @@ public:
 
 protected:
     template<class Func>
-    void BindFunc(const SQChar* name, Func func, SQFUNCTION func_thunk, SQInteger nparamscheck, bool staticVar = false)
+    void BindFunc(const SQChar* name, Func func, SQFUNCTION func_thunk, SQInteger nparamscheck, bool staticVar = false,
+                  const SQChar* typemask = nullptr)
     {
       sq_pushobject(vm, GetObject());
       sq_pushstring(vm, name, -1);
@@ -396,14 +410,15 @@ protected:
       sq_setreleasehook(vm, -1, ImplaceFreeReleaseHook<Func>);
 
       sq_newclosure(vm, func_thunk, 1);
-      if (nparamscheck > 0)
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_setparamscheck(vm, nparamscheck, nullptr)));
+      if (nparamscheck != 0)
+        SQRAT_VERIFY(SQ_SUCCEEDED(sq_setparamscheck(vm, nparamscheck, typemask)));
       SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, staticVar)));
       sq_pop(vm,1); // pop table
     }
 
     template<class Func>
-    void BindFunc(SQInteger index, Func func, SQFUNCTION func_thunk, SQInteger nparamscheck, bool staticVar = false)
+    void BindFunc(SQInteger index, Func func, SQFUNCTION func_thunk, SQInteger nparamscheck, bool staticVar = false,
+                  const SQChar* typemask = nullptr)
     {
       sq_pushobject(vm, GetObject());
       sq_pushinteger(vm, index);
@@ -413,35 +428,18 @@ protected:
       sq_setreleasehook(vm, -1, ImplaceFreeReleaseHook<Func>);
 
       sq_newclosure(vm, func_thunk, 1);
-       if (nparamscheck > 0)
-         SQRAT_VERIFY(SQ_SUCCEEDED(sq_setparamscheck(vm, nparamscheck, nullptr)));
+      if (nparamscheck != 0)
+        SQRAT_VERIFY(SQ_SUCCEEDED(sq_setparamscheck(vm, nparamscheck, typemask)));
       SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, staticVar)));
       sq_pop(vm,1); // pop table
     }
 
     // Bind a function and it's associated Squirrel closure to the object
     template<class Func>
-    void BindOverload(const SQChar* name, Func func, SQFUNCTION func_thunk, SQFUNCTION overload, int argCount, bool staticVar = false) {
-        string overloadName = SqOverloadName::Get(name, argCount);
-
+    void BindOverload(const SQChar* name, Func func, SQFUNCTION func_thunk, SQFUNCTION overload, int argCount, bool staticVar = false,
+                      const SqOverloadSignature& signature = SqOverloadSignature()) {
         sq_pushobject(vm, GetObject());
-
-        // Bind overload handler
-        sq_pushstring(vm, name, -1);
-        sq_pushstring(vm, name, -1); // function name is passed as a free variable
-        sq_newclosure(vm, overload, 1);
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, staticVar)));
-
-        // Bind overloaded function
-        sq_pushstring(vm, overloadName.c_str(), -1);
-
-        SQUserPointer funcPtr = sq_newuserdata(vm, sizeof(func));
-        new (funcPtr) Func(func);
-        sq_setreleasehook(vm, -1, ImplaceFreeReleaseHook<Func>);
-
-        sq_newclosure(vm, func_thunk, 1);
-        SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -3, staticVar)));
-
+        SqBindOverload(vm, name, func_thunk, SqOverloadTable::Own(func), overload, argCount, staticVar, signature);
         sq_pop(vm,1); // pop table
     }
 
@@ -53,69 +53,294 @@ public:
         SQRAT_SPRINTF(&overloadName[0], overloadName.size(), fmtstr, name, args);
         return overloadName;
     }
+
+    // Name of the slot holding the SqOverloadTable of the overloads of name
+    static string GetTable(const SQChar* name) {
+        return string(_SC("__overloads_")) + name;
+    }
 };
 
 
-// Squirrel Overload Functions
-template <class R>
-class SqOverload {
-public:
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Parameter types of an overload, used to choose between overloads taking the same number of arguments
+///
+/// \remarks
+/// Overloads without a match function are only chosen by number of arguments (and replace all the others with it).
+///
+/// \remarks
+/// Numeric parameters accept both integers and floats, so all of them have the same specificity. Among matching
+/// overloads of the same specificity, the one whose numeric parameters have the exact VM type of the arguments
+/// (OT_INTEGER for integral and enum types, OT_FLOAT for floating point types) is chosen, so that f(int) and f(float)
+/// are told apart.
+///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct SqOverloadSignature {
+    const void* types = NULL;             ///< Identifies the parameter types: binding identical ones replaces the overload
+    bool (*match)(HSQUIRRELVM vm) = NULL; ///< Whether the arguments on the stack have the parameter types
+    bool (*exact)(HSQUIRRELVM vm) = NULL; ///< Whether the numeric arguments have the exact VM type, NULL without numeric parameters
+    int (*specificity)() = NULL;          ///< Overloads with a higher specificity are tried first (NULL is 0)
+};
 
-    static SQInteger Func(HSQUIRRELVM vm) {
-        // Get the arg count
-        SQInteger argCount = sq_gettop(vm) - 2;
+// Whether T is a parameter type accepting both integers and floats
+template<class T>
+struct SqOverloadIsNumeric
+  : SQRAT_STD::integral_constant<bool, (SQRAT_STD::is_arithmetic<T>::value && !SQRAT_STD::is_same<T, bool>::value) ||
+                                       SQRAT_STD::is_enum<T>::value> {};
+
+// Whether the argument at idx has the exact VM type of the parameter type T (always true for non numeric types)
+template<class T>
+bool SqOverloadExactType(HSQUIRRELVM vm, SQInteger idx)
+{
+    if constexpr (SQRAT_STD::is_floating_point<T>::value)
+        return sq_gettype(vm, idx) == OT_FLOAT;
+    else if constexpr (SqOverloadIsNumeric<T>::value)
+        return sq_gettype(vm, idx) == OT_INTEGER;
+    else
+        return true;
+}
+
+// Specificity of a parameter of type T. Class depths are read when the overloads are ranked, as the class may not be
+// bound yet when the overload is.
+template<class T>
+int SqOverloadSpecificity()
+{
+    if constexpr (TypeMask<T>::isClass) {
+        // Derived classes are more specific than their bases
+        AbstractStaticClassData* classType = Var<T>::ClassT::getStaticClassDataPtr();
+        return 3 + (classType ? classType->depth : 0);
+    }
+    else if constexpr (TypeMask<T>::value != _SC('.'))
+        return 2;
+    else
+        return TypeMask<T>::exact ? 0 : 1;
+}
+
+// Identity of a list of parameter types. It is the address of writable data rather than of a function, as linkers
+// folding identical code would give the match functions of different types (e.g. int and float) the same address.
+template<class... A>
+struct SqOverloadTypes
+{
+    static const void* Get() {
+        static char tag;
+        return &tag;
+    }
+};
 
-        const SQChar* funcName = _SC("n/a");
-        sq_getstring(vm, -1, &funcName); // get the function name (free variable)
+template<SQInteger startIdx, class... A>
+struct SqOverloadSignatureGen
+{
+    static bool Match(HSQUIRRELVM vm) {
+        return vargs::match_var_types<A...>(vm, startIdx);
+    }
 
-        string overloadName = SqOverloadName::Get(funcName, argCount);
+    static bool Exact(HSQUIRRELVM vm) {
+        return ExactTypes(vm, SQRAT_STD::index_sequence_for<A...>());
+    }
 
-        sq_pushstring(vm, overloadName.c_str(), -1);
+    static int Specificity() {
+        return (SqOverloadSpecificity<A>() + ... + 0);
+    }
 
-        if (SQ_FAILED(sq_get(vm, 1))) { // Lookup the proper overload
-            return sq_throwerror(vm, _SC("wrong number of parameters"));
+    static SqOverloadSignature Get() {
+        SqOverloadSignature signature;
+        signature.types = SqOverloadTypes<A...>::Get();
+        signature.match = &Match;
+        signature.exact = (SqOverloadIsNumeric<A>::value || ...) ? &Exact : NULL;
+        signature.specificity = &Specificity;
+        return signature;
+    }
+
+private:
+
+    template<size_t... Indeces>
+    static bool ExactTypes(HSQUIRRELVM vm, SQRAT_STD::index_sequence<Indeces...>) {
+        ((void)vm);
+        return (SqOverloadExactType<A>(vm, startIdx + Indeces) && ...);
+    }
+};
+
+template<SQInteger startIdx, class Sig>
+struct SqOverloadSignatureOf;
+
+// Identical signatures (same decayed parameter types) share their types identity and match function
+template<SQInteger startIdx, class R, class... A>
+struct SqOverloadSignatureOf<startIdx, R(A...)> : SqOverloadSignatureGen<startIdx, SQRAT_STD::decay_t<A>...> {};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Overloads of a function by number of arguments, held by the userdata free variable of its dispatcher closure
+///
+/// \remarks
+/// Tables are never changed once bound: binding another overload clones the table into a new dispatcher, so that
+/// functions inherited by derived classes keep their own overloads. Cloned tables share the callables.
+/// Overloads taking the same number of arguments are candidates ordered by decreasing specificity: the first one
+/// matching the arguments is called, unless one of the same specificity matches the exact VM types of the numeric
+/// arguments (see SqOverloadSignature), or the last one (which then reports the type error) if none does.
+/// Candidates are ranked again when a class is bound or released, as specificities depend on class depths.
+///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct SqOverloadTable {
+
+    struct Entry {
+        SQFUNCTION thunk = NULL;
+        shared_ptr<void> func; ///< Callable passed to the thunk
+        SqOverloadSignature signature;
+        int specificity = 0;   ///< Value of signature.specificity when the candidates were last ranked
+    };
+
+    vector<vector<Entry>> entries; ///< Candidates indexed by number of arguments
+    unsigned rankedVersion = 0;    ///< AbstractStaticClassData::HierarchyVersion() when the candidates were last ranked
+
+    const Entry* Find(HSQUIRRELVM vm, SQInteger argCount) {
+        if (argCount < 0 || argCount >= SQInteger(entries.size()) || entries[argCount].empty())
+            return NULL;
+        const vector<Entry>& candidates = entries[argCount];
+        if (candidates.size() == 1)
+            return &candidates[0];
+        if (rankedVersion != AbstractStaticClassData::HierarchyVersion())
+            Rank();
+        const Entry* found = NULL;
+        for (const Entry& candidate : candidates) {
+            if (found && candidate.specificity < found->specificity)
+                break;
+            if (!candidate.signature.match(vm))
+                continue;
+            if (!candidate.signature.exact || candidate.signature.exact(vm))
+                return &candidate;
+            if (!found)
+                found = &candidate; // numeric arguments need a conversion, look for an exact match of the same specificity
+        }
+        return found ? found : &candidates.back();
+    }
+
+    /// Returns a copy of a callable owned by the table entries
+    template<class F>
+    static shared_ptr<void> Own(const F& func) {
+        return shared_ptr<void>(new F(func), [](void* p) { delete static_cast<F*>(p); });
+    }
+
+    void Set(SQInteger argCount, SQFUNCTION thunk, const shared_ptr<void>& func, const SqOverloadSignature& signature) {
+        SQRAT_ASSERT(argCount >= 0);
+        if (argCount >= SQInteger(entries.size()))
+            entries.resize(argCount + 1);
+        vector<Entry>& candidates = entries[argCount];
+
+        Entry entry;
+        entry.thunk = thunk;
+        entry.func = func;
+        entry.signature = signature;
+
+        if (!signature.match) {
+            candidates.clear();
+            candidates.push_back(entry);
+            return;
+        }
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (candidates[i].signature.types == signature.types || !candidates[i].signature.match) {
+                candidates.erase(candidates.begin() + i); // replaced by an identical or untyped overload
+                break;
+            }
         }
+        candidates.push_back(entry);
+        Rank();
+    }
 
-        // Push the args again
-        for (SQInteger i = 1; i <= argCount + 1; ++i) {
-            sq_push(vm, i);
+    /// Orders the candidates by decreasing specificity, keeping the binding order of those of the same specificity
+    void Rank() {
+        rankedVersion = AbstractStaticClassData::HierarchyVersion();
+        for (vector<Entry>& candidates : entries) {
+            for (Entry& entry : candidates)
+                entry.specificity = entry.signature.specificity ? entry.signature.specificity() : 0;
+            for (size_t i = 1; i < candidates.size(); ++i) {
+                for (size_t j = i; j > 0 && candidates[j - 1].specificity < candidates[j].specificity; --j)
+                    SQRAT_STD::swap(candidates[j - 1], candidates[j]);
+            }
         }
+    }
+
+    /// Returns the table at idx on the stack, or NULL if it isn't one
+    static SqOverloadTable* Get(HSQUIRRELVM vm, SQInteger idx) {
+        SQUserPointer typeTag = NULL;
+        SqOverloadTable* table = NULL;
+        if (sq_gettype(vm, idx) != OT_USERDATA || SQ_FAILED(sq_gettypetag(vm, idx, &typeTag)) || typeTag != TypeTag())
+            return NULL;
+        sq_getuserdata(vm, idx, (SQUserPointer*)&table, NULL);
+        return table;
+    }
+
+    /// Pushes a new table, holding the overloads of from if not NULL
+    static SqOverloadTable* Push(HSQUIRRELVM vm, const SqOverloadTable* from) {
+        SqOverloadTable* table = new (sq_newuserdata(vm, sizeof(SqOverloadTable))) SqOverloadTable;
+        sq_setreleasehook(vm, -1, ImplaceFreeReleaseHook<SqOverloadTable>);
+        sq_settypetag(vm, -1, TypeTag());
+        if (from)
+            table->entries = from->entries;
+        return table;
+    }
+
+private:
 
-        SQRESULT result = sq_call(vm, argCount + 1, true, SQTrue);
-        return SQ_SUCCEEDED(result) ? 1 : SQ_ERROR;
+    static SQUserPointer TypeTag() {
+        static char tag;
+        return &tag;
     }
 };
 
 
-//
-// void return specialization
-//
-template <>
-class SqOverload<void> {
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Binds an overload of name in the table or class on top of the stack
+///
+/// \param func Callable passed to thunk (see SqOverloadTable::Own), or null for thunks that don't need any
+/// \param overload Dispatcher (see SqOverloadFunc)
+///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+inline void SqBindOverload(HSQUIRRELVM vm, const SQChar* name, SQFUNCTION thunk, const shared_ptr<void>& func, SQFUNCTION overload,
+                           SQInteger argCount, bool staticVar, const SqOverloadSignature& signature) {
+    string tableName = SqOverloadName::GetTable(name);
+
+    // Clone the overloads already bound to name, if any
+    SqOverloadTable* table;
+    sq_pushstring(vm, tableName.c_str(), -1);
+    if (SQ_SUCCEEDED(sq_rawget(vm, -2))) {
+        table = SqOverloadTable::Push(vm, SqOverloadTable::Get(vm, -1));
+        sq_remove(vm, -2);
+    }
+    else
+        table = SqOverloadTable::Push(vm, NULL);
+    table->Set(argCount, thunk, func, signature);
+
+    sq_pushstring(vm, tableName.c_str(), -1);
+    sq_push(vm, -2);
+    SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -4, staticVar)));
+
+    // Bind overload handler
+    sq_pushstring(vm, name, -1);
+    sq_push(vm, -2); // overloads are passed as a free variable
+    sq_newclosure(vm, overload, 1);
+    SQRAT_VERIFY(SQ_SUCCEEDED(sq_newslot(vm, -4, staticVar)));
+
+    sq_pop(vm, 1); // pop overloads
+}
+
+
+// Squirrel Overload Functions
+template <class R>
+class SqOverload {
 public:
 
     static SQInteger Func(HSQUIRRELVM vm) {
         // Get the arg count
         SQInteger argCount = sq_gettop(vm) - 2;
 
-        const SQChar* funcName;
-        sq_getstring(vm, -1, &funcName); // get the function name (free variable)
-
-        string overloadName = SqOverloadName::Get(funcName, argCount);
-
-        sq_pushstring(vm, overloadName.c_str(), -1);
+        SqOverloadTable* table = NULL;
+        sq_getuserdata(vm, -1, (SQUserPointer*)&table, NULL); // get the overloads (free variable)
 
-        if (SQ_FAILED(sq_get(vm, 1))) { // Lookup the proper overload
+        const SqOverloadTable::Entry* entry = table->Find(vm, argCount);
+        if (!entry)
             return sq_throwerror(vm, _SC("wrong number of parameters"));
-        }
-
-        // Push the args again
-        for (int i = 1; i <= argCount + 1; ++i) {
-            sq_push(vm, i);
-        }
 
-        SQRESULT result = sq_call(vm, argCount + 1, false, SQTrue);
-        return SQ_SUCCEEDED(result) ? 0 : SQ_ERROR;
+        // The overload runs in this call: it gets its callable on top of the stack instead of its free variable
+        sq_pushuserpointer(vm, entry->func.get());
+        return entry->thunk(vm);
     }
 };
 
@@ -162,6 +387,29 @@ int SqGetArgCount()
   return function_args_num_v<get_callable_function_t<F>>;
 }
 
+// Signature of an overload of F whose arguments start at startIdx on the stack
+template<class F, SQInteger startIdx = 2>
+SqOverloadSignature SqGetOverloadSignature()
+{
+  return SqOverloadSignatureOf<startIdx, get_callable_function_t<F>>::Get();
+}
+
+template<class Sig, SQChar... prefix>
+struct SqTypeMaskGen;
+
+template<class R, class... A, SQChar... prefix>
+struct SqTypeMaskGen<R(A...), prefix...>
+{
+  static constexpr SQChar value[] = { prefix..., TypeMask<A>::value..., _SC('\0') };
+};
+
+// Typemask of the parameters of F for sq_setparamscheck, after the characters given by prefix (e.g. the one of 'this')
+template<class F, SQChar... prefix>
+const SQChar* SqGetTypeMask()
+{
+  return SqTypeMaskGen<get_callable_function_t<F>, prefix...>::value;
+}
+
 /// @endcond
 
 }
@@ -111,7 +111,45 @@ public:
     /// Sets a key in the Table to a specific function
     template<class F>
     TableBase& Func(const SQChar* name, F method) {
-        BindFunc<F>(name, method, SqGlobalThunk<F>(), 1+SqGetArgCount<F>());
+        BindFunc<F>(name, method, SqGlobalThunk<F, ArgCheck::Unmasked>(), 1+SqGetArgCount<F>(), false,
+                    SqGetTypeMask<F, _SC('.')>());
+        return *this;
+    }
+
+    /// Sets a key in the Table to a function known at compile time (e.g. Func<&function>("function")), which is called
+    /// directly by its thunk without a free variable
+    template<auto F>
+    TableBase& Func(const SQChar* name) {
+        return SquirrelFunc(name, SqGlobalThunkDirect<F, ArgCheck::Unmasked>(), 1+SqGetArgCount<decltype(F)>(),
+                            SqGetTypeMask<decltype(F), _SC('.')>());
+    }
+
+    /// Sets a key in the Table to a function called only by trusted scripts: only the number of arguments is checked, unless
+    /// SQRAT_VALIDATE_UNCHECKED is set (see Class::FuncUnchecked)
+    template<class F>
+    TableBase& FuncUnchecked(const SQChar* name, F method) {
+        BindFunc<F>(name, method, SqGlobalThunk<F, ArgCheck::None>(), 1+SqGetArgCount<F>());
+        return *this;
+    }
+
+    /// Sets a key in the Table to a function known at compile time called only by trusted scripts (see FuncUnchecked)
+    template<auto F>
+    TableBase& FuncUnchecked(const SQChar* name) {
+        return SquirrelFunc(name, SqGlobalThunkDirect<F, ArgCheck::None>(), 1+SqGetArgCount<decltype(F)>());
+    }
+
+    /// Sets a key in the Table to a function taking any number of arguments as an ArgSpan (see Class::VarargFunc)
+    template<class F>
+    TableBase& VarargFunc(const SQChar* name, F method) {
+        BindFunc<F>(name, method, SqGlobalVarargThunk<F>(), 0);
+        return *this;
+    }
+
+    /// Sets a key in the Table to a function returning a class, which can also be called with an extra destination
+    /// instance receiving the result (see Class::FuncDest)
+    template<class F>
+    TableBase& FuncDest(const SQChar* name, F method) {
+        BindFunc<F>(name, method, SqGlobalThunkDest<F>(), 0);
         return *this;
     }
 
@@ -119,12 +157,13 @@ public:
     /// Sets a key in the Table to a specific function and allows the key to be overloaded with functions of a different amount of arguments
     ///
     /// \remarks
-    /// Overloading in Sqrat does not work for functions with the same amount of arguments (just like in Squirrel).
+    /// Functions with the same amount of arguments are chosen by the types of the arguments (see Class::Overload).
     ///
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     template<class F>
     TableBase& Overload(const SQChar* name, F method) {
-        BindOverload(name, method, SqGlobalOverloadedFunc<F>(), SqOverloadFunc<F>(), SqGetArgCount<F>());
+        BindOverload(name, method, SqGlobalOverloadedFunc<F>(), SqOverloadFunc<F>(), SqGetArgCount<F>(), false,
+                     SqGetOverloadSignature<F>());
         return *this;
     }
 
@@ -71,6 +71,14 @@ struct popAsInt
         }
         return false;
     }
+
+    /// Converts a numeric object already fetched from the stack
+    static T get(const HSQOBJECT& obj)
+    {
+        if (obj._type == OT_FLOAT)
+            return static_cast<T>(static_cast<int>(obj._unVal.fFloat));
+        return static_cast<T>(obj._unVal.nInteger);
+    }
 };
 
 
@@ -108,6 +116,24 @@ struct popAsFloat
         }
         return false;
     }
+
+    /// Converts a numeric object already fetched from the stack
+    static T get(const HSQOBJECT& obj)
+    {
+        if (obj._type == OT_FLOAT)
+            return static_cast<T>(obj._unVal.fFloat);
+        return static_cast<T>(obj._unVal.nInteger);
+    }
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Argument fetched from the stack once by vargs::get_var_object, then checked and converted by Var without querying
+/// the stack again
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct VarObject {
+    HSQOBJECT obj;         ///< The object at the index of the argument
+    void* instance = NULL; ///< Native object of a class argument, found while checking it
 };
 
 
@@ -115,21 +141,27 @@ struct popAsFloat
 /// Used to get and push class instances to and from the stack as copies
 ///
 /// \remarks
-/// This specialization requires T to have a default constructor.
+/// Getting doesn't copy: value refers to the object of the instance, which is only copied where a T is initialized from
+/// it (e.g. a parameter taken by value), so it must not be used after the instance is released.
+///
+/// \remarks
+/// Bound functions can take classes without a default constructor, as their arguments are checked before the Var is
+/// made. Getting a value directly off the stack (e.g. Object::Cast) requires T to have a default constructor, which
+/// gives the value of failed get operations.
 ///
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<class T, class>
 struct Var {
 
     using ClassT = ClassType<remove_const_t<T>>;
-    T value; ///< The actual value of get operations
+    const T& value; ///< The actual value of get operations
 
     /// Attempts to get the value off the stack at idx as the given type
-    Var(HSQUIRRELVM vm, SQInteger idx) {
-        T* ptr = ClassT::GetInstance(vm, idx);
-        if (ptr != NULL) {
-            value = *ptr;
-        }
+    Var(HSQUIRRELVM vm, SQInteger idx) : value(get(vm, idx)) {
+    }
+
+    /// Gets the value from the argument at idx, already fetched and accepted by check_object
+    Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(get(arg)) {
     }
 
     /// Called by Sqrat::PushVar to put a class object on the stack
@@ -140,11 +172,47 @@ struct Var {
             SQRAT_ASSERTF(0, "Class/typename was not bound");
     }
 
+    /// Called by Sqrat::PushVarResult to move a temporary class object into a new instance on the stack (null if the
+    /// instance can't be set up)
+    static void push(HSQUIRRELVM vm, T&& value) {
+        if (ClassT::hasClassData(vm)) {
+            if (!ClassT::PushInstanceMove(vm, value))
+                sq_pushnull(vm);
+        }
+        else
+            SQRAT_ASSERTF(0, "Class/typename was not bound");
+    }
+
     static const SQChar * getVarTypeName() { return _SC("native instance"); }
 
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) {
         return ClassT::IsClassInstance(vm, idx);
     }
+
+    static bool check_object(HSQUIRRELVM vm, SQInteger idx, VarObject& arg) {
+        arg.instance = ClassT::GetClassInstance(vm, idx, arg.obj);
+        return arg.instance != NULL;
+    }
+
+private:
+
+    // Failed get operations (GetInstance has already reported the error) get a default constructed object, so this
+    // requires T to have a default constructor. Argument thunks use the other overload instead, which has none.
+    static const T& get(HSQUIRRELVM vm, SQInteger idx) {
+        static_assert(SQRAT_STD::is_default_constructible<T>::value,
+                      "Getting a class without a default constructor requires an object checked by vargs::get_var_object");
+        T* ptr = ClassT::GetInstance(vm, idx);
+        if (ptr != NULL)
+            return *ptr;
+        static const remove_const_t<T> defaultValue{};
+        return defaultValue;
+    }
+
+    // vargs::get_var_object has already made sure that the instance has a native object
+    static const T& get(const VarObject& arg) {
+        SQRAT_ASSERT(arg.instance != NULL);
+        return *static_cast<const T*>(arg.instance);
+    }
 };
 
 // Var<T> trait to find-out whether value can be used after Var has been
@@ -156,7 +224,70 @@ struct VarControlsValueLifeTime
   enum {value = 0};
 };
 
-template<class Callable> SQFUNCTION SqGlobalThunk();
+// Whether functions bound with FuncUnchecked still check their arguments (by default only in debug builds)
+#ifndef SQRAT_VALIDATE_UNCHECKED
+# ifdef NDEBUG
+#  define SQRAT_VALIDATE_UNCHECKED 0
+# else
+#  define SQRAT_VALIDATE_UNCHECKED 1
+# endif
+#endif
+
+/// Argument checks done by a thunk: all of them, only those not already done by the VM through the typemask of its
+/// closure, or none for trusted callers (see SQRAT_VALIDATE_UNCHECKED)
+enum class ArgCheck
+{
+    All,
+    Unmasked,
+    None
+};
+
+template<ArgCheck check>
+constexpr bool arg_check_enabled = check != ArgCheck::None || SQRAT_VALIDATE_UNCHECKED;
+
+template<class T, class = void>
+struct has_class_var : public SQRAT_STD::false_type {};
+
+template<class T>
+struct has_class_var<T, void_t<typename Var<T>::ClassT>> : public SQRAT_STD::true_type {};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Typemask character of parameters of type T, as used by sq_setparamscheck
+///
+/// \remarks
+/// exact is true when the VM check is all Var<T>::check_type does, so that thunks can skip it. Specialize this for custom
+/// Var types that have a matching typemask.
+///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+struct TypeMask
+{
+    using U = SQRAT_STD::remove_cv_t<SQRAT_STD::remove_reference_t<T>>;
+    static constexpr bool isString = SQRAT_STD::is_same<U, SQChar*>::value || SQRAT_STD::is_same<U, const SQChar*>::value ||
+                                     SQRAT_STD::is_same<U, string>::value;
+    static constexpr bool isClass = has_class_var<T>::value;
+
+    static constexpr SQChar value = isClass ? _SC('x') :
+                                    SQRAT_STD::is_same<U, bool>::value ? _SC('.') :
+                                    SQRAT_STD::is_enum<U>::value ? _SC('i') :
+                                    SQRAT_STD::is_arithmetic<U>::value ? _SC('n') :
+                                    isString ? _SC('s') : _SC('.');
+    static constexpr bool exact = !isClass && (SQRAT_STD::is_arithmetic<U>::value || SQRAT_STD::is_enum<U>::value || isString);
+};
+
+template<class Callable, ArgCheck check = ArgCheck::All> SQFUNCTION SqGlobalThunk();
+
+// Callable of a thunk: the userdata free variable of its closure, or the pointer pushed by the overload dispatcher
+template<class Callable, bool overloaded>
+Callable* SqGetCallable(HSQUIRRELVM vm)
+{
+    Callable* callable = NULL;
+    if constexpr (overloaded)
+        sq_getuserpointer(vm, -1, (SQUserPointer*)&callable);
+    else
+        sq_getuserdata(vm, -1, (SQUserPointer*)&callable, NULL);
+    return callable;
+}
 
 template<typename Func>
 struct Var<Func, SQRAT_STD::enable_if_t<std::is_function_v<Func> || SQRAT_STD::is_member_function_pointer<Func>::value>>
@@ -183,6 +314,10 @@ struct Var<T&> {
     Var(HSQUIRRELVM vm, SQInteger idx) : value(*ClassT::GetInstance(vm, idx)) {
     }
 
+    /// Gets the value from the argument at idx, already fetched and accepted by check_object
+    Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(*static_cast<T*>(arg.instance)) {
+    }
+
     /// Called by Sqrat::PushVarR to put a class object on the stack
     static void push(HSQUIRRELVM vm, T& value) {
         if (ClassT::hasClassData(vm))
@@ -201,6 +336,11 @@ struct Var<T&> {
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) {
         return ClassT::IsClassInstance(vm, idx);
     }
+
+    static bool check_object(HSQUIRRELVM vm, SQInteger idx, VarObject& arg) {
+        arg.instance = ClassT::GetClassInstance(vm, idx, arg.obj);
+        return arg.instance != NULL;
+    }
 };
 
 /// Used to get and push class instances to and from the stack as pointers
@@ -214,6 +354,10 @@ struct Var<T*, SQRAT_STD::enable_if_t<!is_callable_v<T*>>> {
     Var(HSQUIRRELVM vm, SQInteger idx) : value(ClassT::GetInstance(vm, idx, true)) {
     }
 
+    /// Gets the value from the argument at idx, already fetched and accepted by check_object
+    Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(static_cast<T*>(arg.instance)) {
+    }
+
     /// Called by Sqrat::PushVar to put a class object on the stack
     static void push(HSQUIRRELVM vm, T* value) {
         if (ClassT::hasClassData(vm))
@@ -227,48 +371,75 @@ struct Var<T*, SQRAT_STD::enable_if_t<!is_callable_v<T*>>> {
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) {
         return ClassT::IsClassInstance(vm, idx);
     }
+
+    static bool check_object(HSQUIRRELVM vm, SQInteger idx, VarObject& arg) {
+        arg.instance = ClassT::GetClassInstance(vm, idx, arg.obj);
+        return arg.instance != NULL;
+    }
 };
 
 
-/// Used to get (as copies) and push (as references) class instances to and from the stack as a std::shared_ptr
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Used to get and push class instances to and from the stack as shared pointers (SharedPtr is std::shared_ptr or eastl::shared_ptr)
+///
+/// \remarks
+/// For bound classes the pushed instance shares the ownership of the object, and getting it back returns a pointer sharing
+/// the same ownership without copying the object. Other instances and non-class types are copied into a new object.
+///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<class T> void PushVarR(HSQUIRRELVM vm, T& value);
-template<class T>
-struct Var<std::shared_ptr<T> > {
+template<class T, template<class> class SharedPtr>
+struct SharedPtrVar {
 
-    std::shared_ptr<T> value; ///< The actual value of get operations
+    SharedPtr<T> value; ///< The actual value of get operations
 
     /// Attempts to get the value off the stack at idx as the given type
-    Var(HSQUIRRELVM vm, SQInteger idx) {
-        if (sq_gettype(vm, idx) != OT_NULL) {
-            Var<T> instance(vm, idx);
-            value.reset(new T(instance.value));
+    SharedPtrVar(HSQUIRRELVM vm, SQInteger idx) {
+        if (sq_gettype(vm, idx) == OT_NULL)
+            return;
+        if constexpr (SQRAT_STD::is_class<T>::value) {
+            using ClassT = ClassType<remove_const_t<T>>;
+            if (ClassT::hasClassData(vm)) {
+                T* ptr = ClassT::GetInstance(vm, idx);
+                if (ptr == NULL)
+                    return;
+                if (const SharedPtr<void>* owner = ClassT::template GetSharedOwner<SharedPtr<void>>(vm, idx))
+                    value = SharedPtr<T>(*owner, ptr);
+                else
+                    value.reset(new T(*ptr));
+                return;
+            }
         }
+        Var<remove_const_t<T>> instance(vm, idx);
+        value.reset(new T(instance.value));
     }
 
     /// Called by Sqrat::PushVar to put a class object on the stack
-    static void push(HSQUIRRELVM vm, const std::shared_ptr<T>& value) {
+    static void push(HSQUIRRELVM vm, const SharedPtr<T>& value) {
+        if (!value) {
+            sq_pushnull(vm);
+            return;
+        }
+        if constexpr (SQRAT_STD::is_class<T>::value) {
+            using ClassT = ClassType<remove_const_t<T>>;
+            if (ClassT::hasClassData(vm)) {
+                ClassT::template PushSharedInstance<SharedPtr<void>>(vm, value);
+                return;
+            }
+        }
         PushVarR(vm, *value);
     }
 };
 
-#if defined(SQRAT_HAS_EASTL)
 template<class T>
-struct Var<eastl::shared_ptr<T> > {
-
-    eastl::shared_ptr<T> value; ///< The actual value of get operations
-
-    /// Attempts to get the value off the stack at idx as the given type
-    Var(HSQUIRRELVM vm, SQInteger idx) {
-        if (sq_gettype(vm, idx) != OT_NULL) {
-            Var<T> instance(vm, idx);
-            value.reset(new T(instance.value));
-        }
-    }
+struct Var<std::shared_ptr<T> > : public SharedPtrVar<T, std::shared_ptr> {
+    Var(HSQUIRRELVM vm, SQInteger idx) : SharedPtrVar<T, std::shared_ptr>(vm, idx) {}
+};
 
-    /// Called by Sqrat::PushVar to put a class object on the stack
-    static void push(HSQUIRRELVM vm, const eastl::shared_ptr<T>& value) {
-        PushVarR(vm, *value);
-    }
+#if defined(SQRAT_HAS_EASTL)
+template<class T>
+struct Var<eastl::shared_ptr<T> > : public SharedPtrVar<T, eastl::shared_ptr> {
+    Var(HSQUIRRELVM vm, SQInteger idx) : SharedPtrVar<T, eastl::shared_ptr>(vm, idx) {}
 };
 #endif
 
@@ -280,11 +451,14 @@ struct Var<eastl::shared_ptr<T> > {
      Var(HSQUIRRELVM vm, SQInteger idx) { \
          popAsInt<type>::pop(vm, idx, value); \
      } \
+     Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(popAsInt<type>::get(arg.obj)) { \
+     } \
      static void push(HSQUIRRELVM vm, type value) { \
          sq_pushinteger(vm, static_cast<SQInteger>(value)); \
      } \
     static const SQChar * getVarTypeName() { return _SC("integer"); } \
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) { return sq_gettype(vm, idx) & SQOBJECT_NUMERIC; } \
+    static bool check_object(HSQUIRRELVM, SQInteger, VarObject& arg) { return arg.obj._type & SQOBJECT_NUMERIC; } \
  };\
  \
  template<> \
@@ -293,11 +467,14 @@ struct Var<eastl::shared_ptr<T> > {
      Var(HSQUIRRELVM vm, SQInteger idx) { \
          popAsInt<type>::pop(vm, idx, value); \
      } \
+     Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(popAsInt<type>::get(arg.obj)) { \
+     } \
      static void push(HSQUIRRELVM vm, type& value) { \
          sq_pushinteger(vm, static_cast<SQInteger>(value)); \
      } \
     static const SQChar * getVarTypeName() { return _SC("integer ref"); } \
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) { return sq_gettype(vm, idx) & SQOBJECT_NUMERIC; } \
+    static bool check_object(HSQUIRRELVM, SQInteger, VarObject& arg) { return arg.obj._type & SQOBJECT_NUMERIC; } \
  }; \
  \
  template<> \
@@ -306,11 +483,14 @@ struct Var<eastl::shared_ptr<T> > {
      Var(HSQUIRRELVM vm, SQInteger idx) { \
          popAsInt<type>::pop(vm, idx, value); \
      } \
+     Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(popAsInt<type>::get(arg.obj)) { \
+     } \
      static void push(HSQUIRRELVM vm, type value) { \
          sq_pushinteger(vm, static_cast<SQInteger>(value)); \
      } \
     static const SQChar * getVarTypeName() { return _SC("integer const ref"); } \
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) { return sq_gettype(vm, idx) & SQOBJECT_NUMERIC; } \
+    static bool check_object(HSQUIRRELVM, SQInteger, VarObject& arg) { return arg.obj._type & SQOBJECT_NUMERIC; } \
  };
 
 SQRAT_INTEGER(unsigned int)
@@ -339,11 +519,14 @@ SQRAT_INTEGER(signed __int64)
      Var(HSQUIRRELVM vm, SQInteger idx) { \
          popAsFloat<type>::pop(vm, idx, value); \
      } \
+     Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(popAsFloat<type>::get(arg.obj)) { \
+     } \
      static void push(HSQUIRRELVM vm, const type& value) { \
          sq_pushfloat(vm, static_cast<SQFloat>(value)); \
      } \
     static const SQChar * getVarTypeName() { return _SC("float"); } \
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) { return sq_gettype(vm, idx) & SQOBJECT_NUMERIC; } \
+    static bool check_object(HSQUIRRELVM, SQInteger, VarObject& arg) { return arg.obj._type & SQOBJECT_NUMERIC; } \
  }; \
  \
  template<> \
@@ -352,11 +535,14 @@ SQRAT_INTEGER(signed __int64)
      Var(HSQUIRRELVM vm, SQInteger idx) { \
          popAsFloat<type>::pop(vm, idx, value); \
      } \
+     Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(popAsFloat<type>::get(arg.obj)) { \
+     } \
      static void push(HSQUIRRELVM vm, const type& value) { \
          sq_pushfloat(vm, static_cast<SQFloat>(value)); \
      } \
     static const SQChar * getVarTypeName() { return _SC("float const ref"); } \
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) { return sq_gettype(vm, idx) & SQOBJECT_NUMERIC; } \
+    static bool check_object(HSQUIRRELVM, SQInteger, VarObject& arg) { return arg.obj._type & SQOBJECT_NUMERIC; } \
  };
 
 SQRAT_FLOAT(float)
@@ -375,6 +561,8 @@ struct Var<T, typename SQRAT_STD::enable_if<SQRAT_STD::is_enum<T>::value, void>:
         if (SQ_SUCCEEDED(sq_getinteger(vm, idx, &intVal)))
             value = static_cast<T>(intVal);
      }
+    Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(static_cast<T>(arg.obj._unVal.nInteger)) {
+    }
 
      static void push(HSQUIRRELVM vm, T value) {
          sq_pushinteger(vm, static_cast<SQInteger>(value));
@@ -383,9 +571,21 @@ struct Var<T, typename SQRAT_STD::enable_if<SQRAT_STD::is_enum<T>::value, void>:
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) {
         return sq_gettype(vm, idx) == OT_INTEGER;
     }
+    static bool check_object(HSQUIRRELVM, SQInteger, VarObject& arg) {
+        return arg.obj._type == OT_INTEGER;
+    }
 };
 
 
+// Truth value of an object, the same as sq_tobool gives for it on the stack
+inline bool ObjectToBool(const HSQOBJECT& obj) {
+    if (!(obj._type & SQOBJECT_CANBEFALSE))
+        return true;
+    if (obj._type == OT_FLOAT)
+        return obj._unVal.fFloat != 0;
+    return obj._unVal.nInteger != 0;
+}
+
 /// Used to get and push bools to and from the stack
 template<>
 struct Var<bool> {
@@ -398,6 +598,10 @@ struct Var<bool> {
         value = (sqValue != 0);
     }
 
+    /// Gets the value from the argument at idx, already fetched by vargs::get_var_object
+    Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(ObjectToBool(arg.obj)) {
+    }
+
     /// Called by Sqrat::PushVar to put a bool on the stack
     static void push(HSQUIRRELVM vm, const bool& value) {
         sq_pushbool(vm, static_cast<SQBool>(value));
@@ -405,6 +609,7 @@ struct Var<bool> {
 
     static const SQChar * getVarTypeName() { return _SC("bool"); }
     static bool check_type(HSQUIRRELVM /*vm*/, SQInteger /*idx*/) { return true; }
+    static bool check_object(HSQUIRRELVM /*vm*/, SQInteger /*idx*/, VarObject& /*arg*/) { return true; }
 };
 
 template<>
@@ -418,6 +623,10 @@ struct Var<const bool&> {
         value = (sqValue != 0);
     }
 
+    /// Gets the value from the argument at idx, already fetched by vargs::get_var_object
+    Var(HSQUIRRELVM, SQInteger, const VarObject& arg) : value(ObjectToBool(arg.obj)) {
+    }
+
     /// Called by Sqrat::PushVar to put a bool on the stack
     static void push(HSQUIRRELVM vm, const bool& value) {
         sq_pushbool(vm, static_cast<SQBool>(value));
@@ -425,6 +634,7 @@ struct Var<const bool&> {
 
     static const SQChar * getVarTypeName() { return _SC("bool const ref"); }
     static bool check_type(HSQUIRRELVM /*vm*/, SQInteger /*idx*/) { return true; }
+    static bool check_object(HSQUIRRELVM /*vm*/, SQInteger /*idx*/, VarObject& /*arg*/) { return true; }
 };
 
 /// Used to get and push strings as SQChar arrays to and from the stack
@@ -450,6 +660,19 @@ public:
         v = vm;
     }
 
+    /// Gets the value from the argument at idx, already fetched by vargs::get_var_object
+    Var(HSQUIRRELVM vm, SQInteger idx, const VarObject& arg) : obj(arg.obj), v(vm) {
+        bool converted = obj._type != OT_STRING; // only for trusted callers, which skip check_object
+        if (converted) {
+            sq_tostring(vm, idx);
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, -1, &obj)));
+        }
+        sq_getstringandsize(vm, converted ? -1 : idx, (const SQChar**)&value, &valueLen);
+        sq_addref(vm, &obj);
+        if (converted)
+            sq_pop(vm,1);
+    }
+
     Var(Var<SQChar *> const &rhs)
       : obj(rhs.obj)
       , v(rhs.v)
@@ -483,6 +706,7 @@ public:
 
     static const SQChar * getVarTypeName() { return _SC("string"); }
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) { return sq_gettype(vm, idx) == OT_STRING; }
+    static bool check_object(HSQUIRRELVM /*vm*/, SQInteger /*idx*/, VarObject& arg) { return arg.obj._type == OT_STRING; }
 };
 
 template<>
@@ -512,6 +736,19 @@ public:
         v = vm;
     }
 
+    /// Gets the value from the argument at idx, already fetched by vargs::get_var_object
+    Var(HSQUIRRELVM vm, SQInteger idx, const VarObject& arg) : obj(arg.obj), v(vm) {
+        bool converted = obj._type != OT_STRING; // only for trusted callers, which skip check_object
+        if (converted) {
+            sq_tostring(vm, idx);
+            SQRAT_VERIFY(SQ_SUCCEEDED(sq_getstackobj(vm, -1, &obj)));
+        }
+        sq_getstringandsize(vm, converted ? -1 : idx, &value, &valueLen);
+        sq_addref(vm, &obj);
+        if (converted)
+            sq_pop(vm,1);
+    }
+
     Var(Var<const SQChar *> const &rhs)
       : obj(rhs.obj)
       , v(rhs.v)
@@ -545,6 +782,7 @@ public:
 
     static const SQChar * getVarTypeName() { return _SC("string"); }
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) { return sq_gettype(vm, idx) == OT_STRING; }
+    static bool check_object(HSQUIRRELVM /*vm*/, SQInteger /*idx*/, VarObject& arg) { return arg.obj._type == OT_STRING; }
 };
 
 template<>
@@ -568,6 +806,19 @@ struct Var<string> {
         sq_pop(vm,1);
     }
 
+    /// Gets the value from the argument at idx, already fetched by vargs::get_var_object
+    Var(HSQUIRRELVM vm, SQInteger idx, const VarObject& arg) {
+        const SQChar* ret = nullptr;
+        SQInteger len = 0;
+        bool converted = arg.obj._type != OT_STRING; // only for trusted callers, which skip check_object
+        if (converted)
+            sq_tostring(vm, idx);
+        sq_getstringandsize(vm, converted ? -1 : idx, &ret, &len);
+        value = string(ret, len);
+        if (converted)
+            sq_pop(vm,1);
+    }
+
     /// Called by Sqrat::PushVar to put a string on the stack
     static void push(HSQUIRRELVM vm, const string& value) {
         sq_pushstring(vm, value.c_str(), value.size());
@@ -575,6 +826,7 @@ struct Var<string> {
 
     static const SQChar * getVarTypeName() { return _SC("string"); }
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) { return sq_gettype(vm, idx) == OT_STRING; }
+    static bool check_object(HSQUIRRELVM /*vm*/, SQInteger /*idx*/, VarObject& arg) { return arg.obj._type == OT_STRING; }
 };
 
 /// Used to get and push const string references to and from the stack as copies (strings are always copied)
@@ -592,6 +844,19 @@ struct Var<const string&> {
         sq_pop(vm,1);
     }
 
+    /// Gets the value from the argument at idx, already fetched by vargs::get_var_object
+    Var(HSQUIRRELVM vm, SQInteger idx, const VarObject& arg) {
+        const SQChar* ret = nullptr;
+        SQInteger len = 0;
+        bool converted = arg.obj._type != OT_STRING; // only for trusted callers, which skip check_object
+        if (converted)
+            sq_tostring(vm, idx);
+        sq_getstringandsize(vm, converted ? -1 : idx, &ret, &len);
+        value = string(ret, len);
+        if (converted)
+            sq_pop(vm,1);
+    }
+
     /// Called by Sqrat::PushVar to put a string on the stack
     static void push(HSQUIRRELVM vm, const string& value) {
         sq_pushstring(vm, value.c_str(), value.size());
@@ -599,6 +864,7 @@ struct Var<const string&> {
 
     static const SQChar * getVarTypeName() { return _SC("string"); }
     static bool check_type(HSQUIRRELVM vm, SQInteger idx) { return sq_gettype(vm, idx) == OT_STRING; }
+    static bool check_object(HSQUIRRELVM /*vm*/, SQInteger /*idx*/, VarObject& arg) { return arg.obj._type == OT_STRING; }
 };
 
 
@@ -647,6 +913,23 @@ inline void PushVar(HSQUIRRELVM vm, T& value) {
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Pushes the result of a call returning R on to a given VM's stack
+///
+/// \remarks
+/// References are pushed like PushVar does, while values are passed to Var as temporaries so that class objects
+/// returned by value can be moved into their instances instead of being copied.
+///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class R>
+inline void PushVarResult(HSQUIRRELVM vm, R&& result) {
+    if constexpr (SQRAT_STD::is_reference<R>::value)
+        PushVar(vm, result);
+    else
+        Var<SQRAT_STD::remove_cv_t<R>>::push(vm, SQRAT_STD::move(result));
+}
+
+
 template<class T, bool b>
 struct PushVarR_helper {
     inline static void push(HSQUIRRELVM vm, const T value) {
@@ -679,8 +962,193 @@ inline void PushVarR(HSQUIRRELVM vm, T& value) {
     }
 }
 
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// View of the arguments of a call on the stack of a VM, passed to functions bound with VarargFunc
+///
+/// \remarks
+/// Arguments are only decoded when accessed, through Var<T>. get can't be used for types whose Var holds their value
+/// (e.g. const SQChar*, see VarControlsValueLifeTime): use getVar and keep the Var while using its value.
+/// A span is only valid during the call it was made for.
+///
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ArgSpan {
+public:
+
+    ArgSpan(HSQUIRRELVM v, SQInteger firstIdx, SQInteger count) : vm(v), first(firstIdx), argCount(count) {
+    }
+
+    HSQUIRRELVM GetVM() const {
+        return vm;
+    }
+
+    SQInteger size() const {
+        return argCount;
+    }
+
+    bool empty() const {
+        return argCount == 0;
+    }
+
+    /// Returns the stack index of the argument i
+    SQInteger index(SQInteger i) const {
+        SQRAT_ASSERT(i >= 0 && i < argCount);
+        return first + i;
+    }
+
+    SQObjectType type(SQInteger i) const {
+        return sq_gettype(vm, index(i));
+    }
+
+    /// Returns whether the argument i can be got as a T
+    template<class T>
+    bool is(SQInteger i) const {
+        return Var<T>::check_type(vm, index(i));
+    }
+
+    template<class T>
+    T get(SQInteger i) const {
+        static_assert(!VarControlsValueLifeTime<T>::value, "the value would not outlive its Var, use getVar");
+        return Var<T>(vm, index(i)).value;
+    }
+
+    template<class T>
+    Var<T> getVar(SQInteger i) const {
+        return Var<T>(vm, index(i));
+    }
+
+private:
+
+    HSQUIRRELVM vm;
+    SQInteger first;
+    SQInteger argCount;
+};
+
 namespace vargs
 {
+  template <typename T>
+  void report_type_error(HSQUIRRELVM vm, int idx)
+  {
+    if constexpr (has_class_var<T>::value) {
+      if (Var<T>::ClassT::IsUnconstructedInstance(vm, idx)) {
+        sq_throwerror(vm, _SC("got unconstructed native class (call base.constructor in the constructor of Squirrel classes that extend native classes)"));
+        return;
+      }
+    }
+
+    const SQChar *argTypeName = _SC("unknown");
+    SQInteger prevTop = sq_gettop(vm);
+    if (SQ_SUCCEEDED(sq_typeof(vm, idx))) {
+      sq_tostring(vm, -1);
+      sq_getstring(vm, -1, &argTypeName);
+    }
+
+    auto fmtstr = _SC("Wrong argument type, expected '%s', got '%s'");
+    const auto l = SQRAT_SPRINTF(nullptr, 0, fmtstr, Var<T>::getVarTypeName(), argTypeName);
+    string errMsg(l + 1, '\0');
+    SQRAT_SPRINTF(&errMsg[0], errMsg.size(), fmtstr, Var<T>::getVarTypeName(), argTypeName);
+    sq_settop(vm, prevTop);
+    sq_throwerror(vm, errMsg.c_str());
+  }
+
+  // Whether Var<T> can be checked and constructed from an object already fetched from the stack
+  template <typename T, class = void>
+  struct has_object_check : public SQRAT_STD::false_type {};
+
+  template <typename T>
+  struct has_object_check<T, void_t<decltype(Var<T>::check_object(SQRAT_STD::declval<HSQUIRRELVM>(), SQInteger(0), SQRAT_STD::declval<VarObject&>()))>>
+    : public SQRAT_STD::true_type {};
+
+  // Stack objects of N arguments, fetched by get_var_objects and passed on to make_vars
+  template <size_t N>
+  struct VarObjects
+  {
+    VarObject arg[N > 0 ? N : 1];
+  };
+
+  // Whether Var<T> refers to the native object of an instance, so that it cannot be made if there is none
+  template <typename T>
+  struct refers_to_instance
+    : public SQRAT_STD::integral_constant<bool, has_class_var<T>::value && !SQRAT_STD::is_pointer<T>::value> {};
+
+  template <typename T, ArgCheck check = ArgCheck::All>
+  bool get_var_object(HSQUIRRELVM vm, int idx, VarObject &arg)
+  {
+    if constexpr (!arg_check_enabled<check> || (check == ArgCheck::Unmasked && TypeMask<T>::exact)) {
+      if constexpr (has_object_check<T>::value)
+        sq_getstackobj(vm, idx, &arg.obj);
+      if constexpr (has_class_var<T>::value) {
+        arg.instance = Var<T>::ClassT::GetCheckedInstance(vm, idx, arg.obj);
+        // Even trusted callers must not get a Var without an object to refer to
+        if (refers_to_instance<T>::value && !arg.instance) {
+          sq_throwerror(vm, _SC("got unconstructed native class (call base.constructor in the constructor of Squirrel classes that extend native classes)"));
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool valid;
+    if constexpr (has_object_check<T>::value) {
+      sq_getstackobj(vm, idx, &arg.obj);
+      valid = Var<T>::check_object(vm, idx, arg);
+    }
+    else
+      valid = Var<T>::check_type(vm, idx);
+    if (!valid)
+      report_type_error<T>(vm, idx);
+    return valid;
+  }
+
+  template <ArgCheck check, typename... Args, size_t... Indeces>
+  bool get_var_objects_i(HSQUIRRELVM vm, int idx, VarObjects<sizeof...(Args)> &objs, SQRAT_STD::index_sequence<Indeces...>)
+  {
+    ((void)idx);
+    ((void)vm);
+    ((void)objs);
+    return (get_var_object<Args, check>(vm, idx + Indeces, objs.arg[Indeces]) && ...);
+  }
+
+  // Same as check_var_types, but fetches each argument once so that make_vars can convert it without querying the stack again
+  template <typename... Args>
+  bool get_var_objects(HSQUIRRELVM vm, int idx, VarObjects<sizeof...(Args)> &objs)
+  {
+    return get_var_objects_i<ArgCheck::All, Args...>(vm, idx, objs, SQRAT_STD::index_sequence_for<Args...>());
+  }
+
+  // Same as get_var_objects, skipping the checks given by check (see ArgCheck)
+  template <ArgCheck check, typename... Args>
+  bool get_var_objects(HSQUIRRELVM vm, int idx, VarObjects<sizeof...(Args)> &objs)
+  {
+    return get_var_objects_i<check, Args...>(vm, idx, objs, SQRAT_STD::index_sequence_for<Args...>());
+  }
+
+  template <typename T>
+  Var<T> make_var(HSQUIRRELVM vm, int idx, const VarObject &arg)
+  {
+    if constexpr (has_object_check<T>::value)
+      return Var<T>(vm, idx, arg);
+    else
+      return Var<T>(vm, idx);
+  }
+
+  template <typename... Args, size_t... Indeces>
+  SQRAT_STD::tuple<Var<Args>...> make_vars_i(HSQUIRRELVM vm, int idx, const VarObjects<sizeof...(Args)> &objs,
+                                             SQRAT_STD::index_sequence<Indeces...>)
+  {
+    ((void)idx);
+    ((void)vm);
+    ((void)objs);
+    return SQRAT_STD::make_tuple(make_var<Args>(vm, idx + Indeces, objs.arg[Indeces])...);
+  }
+
+  // Makes the Vars of arguments accepted by get_var_objects
+  template <typename... Args>
+  SQRAT_STD::tuple<Var<Args>...> make_vars(HSQUIRRELVM vm, int idx, const VarObjects<sizeof...(Args)> &objs)
+  {
+    return make_vars_i<Args...>(vm, idx, objs, SQRAT_STD::index_sequence_for<Args...>());
+  }
+
   template <typename... Args, size_t... Indeces>
   SQRAT_STD::tuple<Var<Args>...> make_vars_i(HSQUIRRELVM vm, int idx, SQRAT_STD::index_sequence<Indeces...>)
   {
@@ -699,19 +1167,7 @@ namespace vargs
   bool check_var_types(HSQUIRRELVM vm, int idx)
   {
     if (!Var<T>::check_type(vm, idx)) {
-      const SQChar *argTypeName = _SC("unknown");
-      SQInteger prevTop = sq_gettop(vm);
-      if (SQ_SUCCEEDED(sq_typeof(vm, idx))) {
-        sq_tostring(vm, -1);
-        sq_getstring(vm, -1, &argTypeName);
-      }
-
-      auto fmtstr = _SC("Wrong argument type, expected '%s', got '%s'");
-      const auto l = SQRAT_SPRINTF(nullptr, 0, fmtstr, Var<T>::getVarTypeName(), argTypeName);
-      string errMsg(l + 1, '\0');
-      SQRAT_SPRINTF(&errMsg[0], errMsg.size(), fmtstr, Var<T>::getVarTypeName(), argTypeName);
-      sq_settop(vm, prevTop);
-      sq_throwerror(vm, errMsg.c_str());
+      report_type_error<T>(vm, idx);
       return false;
     }
     return true;
@@ -732,6 +1188,21 @@ namespace vargs
   {
     return true;
   }
+
+  template <typename... Args, size_t... Indeces>
+  bool match_var_types_i(HSQUIRRELVM vm, int idx, SQRAT_STD::index_sequence<Indeces...>)
+  {
+    ((void)idx);
+    ((void)vm);
+    return (Var<Args>::check_type(vm, idx + Indeces) && ...);
+  }
+
+  // Same as check_var_types without reporting errors
+  template <typename... Args>
+  bool match_var_types(HSQUIRRELVM vm, int idx)
+  {
+    return match_var_types_i<Args...>(vm, idx, SQRAT_STD::index_sequence_for<Args...>());
+  }
 }
 }
 
@@ -44,6 +44,7 @@
 
 #include <squirrel.h>
 #include <sqstdaux.h>
+#include <stdint.h>
 
 #if (defined(_MSC_VER) && _MSC_VER >= 1900) || (__cplusplus >= 201402L) || (__cplusplus == 201300L)
 #else
@@ -64,11 +65,13 @@
 # include <EASTL/unordered_map.h>
 # include <EASTL/vector_map.h>
 # include <EASTL/shared_ptr.h>
+# include <EASTL/vector.h>
 EA_DISABLE_ALL_VC_WARNINGS()
 #else
 # include <string>
 # include <unordered_map>
 # include <memory>
+# include <vector>
 # include <tuple>
 # include <type_traits>
 # if __cplusplus >= 201703L
@@ -90,12 +93,14 @@ namespace Sqrat {
   template <class T> using hash = eastl::hash<T>;
   template <class T> using shared_ptr = eastl::shared_ptr<T>;
   template <class T> using weak_ptr = eastl::weak_ptr<T>;
+  template <class T> using vector = eastl::vector<T>;
 
 #else
   using string = std::basic_string<SQChar>;
   template <class T> using hash = std::hash<T>;
   template <class T> using shared_ptr = std::shared_ptr<T>;
   template <class T> using weak_ptr = std::weak_ptr<T>;
+  template <class T> using vector = std::vector<T>;
 
 #if __cplusplus >= 201703L
   using string_view = std::basic_string_view<SQChar>;
@@ -115,6 +120,119 @@ namespace Sqrat {
   using class_hash_map = std::unordered_map<K, V, H>;
 #endif
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Open addressing hash map with pointer keys, used for instance maps when no flat hash map is available
+///
+/// \tparam K Pointer type of the keys (null keys are not allowed, they mark empty slots)
+/// \tparam V Type of the values, must be default constructible and copyable
+///
+/// \remarks
+/// Slots are stored in a single array probed linearly from a Fibonacci hash of the key, and erase shifts the following
+/// entries back instead of leaving tombstones, so lookups never scan more than the cluster of the key.
+/// Only the operations used by Sqrat are provided; the map can't be iterated and find() returns end() (null) on a miss.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class K, class V>
+class ptr_hash_map {
+public:
+    struct value_type {
+        K first;
+        V second;
+    };
+    typedef value_type* iterator;
+
+    ptr_hash_map() : count(0), shift(64) {}
+
+    iterator find(K key) {
+        if (!count || !key)
+            return end();
+        size_t mask = slots.size() - 1;
+        for (size_t i = index(key);; i = (i + 1) & mask) {
+            value_type& slot = slots[i];
+            if (slot.first == key)
+                return &slot;
+            if (!slot.first)
+                return end();
+        }
+    }
+
+    iterator end() { return nullptr; }
+
+    V& operator[](K key) {
+        SQRAT_ASSERT(key);
+        if ((count + 1) * 4 > slots.size() * 3) // keep the load factor under 3/4
+            grow();
+        size_t mask = slots.size() - 1;
+        for (size_t i = index(key);; i = (i + 1) & mask) {
+            value_type& slot = slots[i];
+            if (slot.first == key)
+                return slot.second;
+            if (!slot.first) {
+                slot.first = key;
+                slot.second = V();
+                ++count;
+                return slot.second;
+            }
+        }
+    }
+
+    size_t erase(K key) {
+        iterator it = find(key);
+        if (it == end())
+            return 0;
+        size_t mask = slots.size() - 1;
+        size_t hole = size_t(it - slots.data());
+        for (size_t i = (hole + 1) & mask; slots[i].first; i = (i + 1) & mask) {
+            // Move the entry into the hole unless the hole lies before its home slot in the probe sequence
+            size_t home = index(slots[i].first);
+            if (((i - home) & mask) >= ((i - hole) & mask)) {
+                slots[hole] = slots[i];
+                hole = i;
+            }
+        }
+        slots[hole].first = K();
+        slots[hole].second = V();
+        --count;
+        return 1;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void clear() {
+        for (value_type& slot : slots)
+            slot = value_type();
+        count = 0;
+    }
+
+private:
+    size_t index(K key) const {
+        return size_t((uint64_t(uintptr_t(key)) * UINT64_C(0x9E3779B97F4A7C15)) >> shift);
+    }
+
+    void grow() {
+        vector<value_type> old;
+        old.swap(slots);
+        size_t capacity = old.empty() ? 16 : old.size() * 2;
+        slots.resize(capacity);
+        shift = 64;
+        for (size_t c = capacity; c > 1; c >>= 1)
+            --shift;
+        size_t mask = capacity - 1;
+        for (value_type& entry : old) {
+            if (!entry.first)
+                continue;
+            size_t i = index(entry.first);
+            while (slots[i].first)
+                i = (i + 1) & mask;
+            slots[i] = entry;
+        }
+    }
+
+    vector<value_type> slots;
+    size_t count;
+    unsigned shift;
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// Define an inline function to avoid MSVC's "conditional expression is constant" warning
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -245,6 +363,20 @@ namespace vargs {
     return apply_helper(pf, SQRAT_STD::make_index_sequence<argsN>(), args);
   }
 
+  template <auto F, class Tuple, size_t... Indexes>
+  decltype(auto) apply_direct_helper(SQRAT_STD::index_sequence<Indexes...>, Tuple &args)
+  {
+    return F(SQRAT_STD::get<Indexes>(args).value...);
+  }
+
+  // Same as apply for a function known at compile time, so that the call is direct and can be inlined
+  template <auto F, class Tuple>
+  decltype(auto) apply_direct(Tuple &&args)
+  {
+    constexpr auto argsN = SQRAT_STD::tuple_size<SQRAT_STD::decay_t<Tuple>>::value;
+    return apply_direct_helper<F>(SQRAT_STD::make_index_sequence<argsN>(), args);
+  }
+
   template <class C, class Member, class Tuple, size_t... Indexes>
   decltype(auto) apply_member_helper(C *ptr, Member pf, SQRAT_STD::index_sequence<Indexes...>,
                            Tuple &args)
@@ -258,6 +390,20 @@ namespace vargs {
     constexpr auto argsN = SQRAT_STD::tuple_size<SQRAT_STD::decay_t<Tuple>>::value;
     return apply_member_helper(ptr, pf, SQRAT_STD::make_index_sequence<argsN>(), args);
   }
+
+  template <auto F, class C, class Tuple, size_t... Indexes>
+  decltype(auto) apply_member_direct_helper(C *ptr, SQRAT_STD::index_sequence<Indexes...>, Tuple &args)
+  {
+    return (ptr->*F)(SQRAT_STD::get<Indexes>(args).value...);
+  }
+
+  // Same as apply_member for a member function known at compile time
+  template <auto F, class C, class Tuple>
+  decltype(auto) apply_member_direct(C *ptr, Tuple &&args)
+  {
+    constexpr auto argsN = SQRAT_STD::tuple_size<SQRAT_STD::decay_t<Tuple>>::value;
+    return apply_member_direct_helper<F>(ptr, SQRAT_STD::make_index_sequence<argsN>(), args);
+  }
 #if defined(_MSC_VER)
 #pragma warning(pop)
 #endif